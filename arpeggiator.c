@@ -0,0 +1,159 @@
+/**
+ * @file arpeggiator.c
+ * @brief Arpeggiator over the held keys, on the tick scheduler.
+ */
+#include "arpeggiator.h"
+#include "keypad_events.h"
+#include "metronome.h"
+#include "scheduler.h"
+
+#define ARP_NO_NOTE 0xFF
+
+static ArpNoteFn arp_play;
+static volatile ArpMode arp_mode = ARP_OFF;
+static volatile uint16_t arp_keys = 0;
+static uint8_t arp_notes[KEYPAD_MATRIX_KEYS]; //!< Note of each held key, from its press
+static volatile SchedulerId arp_event = 0;
+static uint8_t arp_last = ARP_NO_NOTE;   //!< Last note played, for the order
+static uint8_t arp_sounding = ARP_NO_NOTE;
+static bool arp_descending = false;      //!< Direction in ARP_UP_DOWN
+static uint32_t arp_rest_us;             //!< Rest after the sounding note
+
+static const char *const arp_mode_names[ARP_MODE_COUNT] = {"off", "up", "down", "up-down"};
+
+/**
+ * @brief Nearest held note above (or below) a note.
+ * @param above true for the next higher note, false for the next lower
+ * @return The note, or ARP_NO_NOTE if there is none
+ */
+static uint8_t arpNeighbour(uint16_t keys, uint8_t from, bool above)
+{
+  uint8_t best = ARP_NO_NOTE;
+  while (keys)
+  {
+    uint8_t note = arp_notes[__builtin_ctz(keys)];
+    keys &= keys - 1;
+    if (above ? (note > from && (best == ARP_NO_NOTE || note < best))
+              : (note < from && (best == ARP_NO_NOTE || note > best)))
+      best = note;
+  }
+  return best;
+}
+
+/**
+ * @brief Picks the next note for the mode from the held keys.
+ */
+static uint8_t arpNextNote(uint16_t keys)
+{
+  bool descending = arp_mode == ARP_DOWN || (arp_mode == ARP_UP_DOWN && arp_descending);
+  uint8_t from = arp_last;
+  if (from == ARP_NO_NOTE)
+    from = descending ? 0xFF : 0;
+
+  uint8_t note = arpNeighbour(keys, from, !descending);
+  if (note != ARP_NO_NOTE)
+    return note;
+
+  if (arp_mode == ARP_UP_DOWN)
+  {
+    // Turn around at the end; with a single note this repeats it.
+    arp_descending = !descending;
+    note = arpNeighbour(keys, from, descending);
+    if (note != ARP_NO_NOTE)
+      return note;
+  }
+  // Wrap to the other end.
+  note = arpNeighbour(keys, descending ? 0xFF : 0, !descending);
+  return note != ARP_NO_NOTE ? note : from;
+}
+
+/**
+ * @brief Scheduler callback: ends the sounding note, or plays the next one.
+ */
+static uint32_t arpStepCallback(void *user_data)
+{
+  (void)user_data;
+
+  if (arp_sounding != ARP_NO_NOTE)
+  {
+    arp_play(arp_sounding, 0);
+    arp_sounding = ARP_NO_NOTE;
+    if (arp_keys != 0 && arp_mode != ARP_OFF)
+      return arp_rest_us;
+  }
+
+  uint16_t keys = arp_keys;
+  if (keys == 0 || arp_mode == ARP_OFF)
+  {
+    // Stopped: the next press starts from the bottom (or top) again.
+    arp_last = ARP_NO_NOTE;
+    arp_descending = false;
+    arp_event = 0;
+    return 0;
+  }
+
+  uint32_t step_us = metronomeBeatUs() / ARP_STEPS_PER_BEAT;
+  uint32_t gate_us = step_us / 100 * ARP_GATE_PERCENT;
+  if (gate_us == 0)
+    gate_us = 1;
+  arp_rest_us = step_us > gate_us ? step_us - gate_us : 1;
+
+  arp_last = arpNextNote(keys);
+  arp_sounding = arp_last;
+  arp_play(arp_sounding, ARP_VELOCITY);
+  return gate_us;
+}
+
+void initArp(ArpNoteFn play)
+{
+  arp_play = play;
+}
+
+void arpSetMode(ArpMode mode)
+{
+  if (mode >= ARP_MODE_COUNT)
+    return;
+  arp_mode = mode;
+  if (mode != ARP_OFF)
+  {
+    arpSetKeys(arp_keys, arp_notes);
+    return;
+  }
+
+  schedulerCancel(arp_event);
+  arp_event = 0;
+  if (arp_sounding != ARP_NO_NOTE)
+  {
+    arp_play(arp_sounding, 0);
+    arp_sounding = ARP_NO_NOTE;
+  }
+  arp_last = ARP_NO_NOTE;
+  arp_descending = false;
+}
+
+ArpMode arpMode(void)
+{
+  return arp_mode;
+}
+
+const char *arpModeName(ArpMode mode)
+{
+  return mode < ARP_MODE_COUNT ? arp_mode_names[mode] : "?";
+}
+
+void arpSetKeys(uint16_t keys, const uint8_t *notes)
+{
+  // Notes of new keys are stored before the keys are published to the step
+  // callback; held keys keep the note they were pressed with.
+  uint16_t pressed = keys & ~arp_keys;
+  while (pressed)
+  {
+    uint8_t key = (uint8_t)__builtin_ctz(pressed);
+    pressed &= pressed - 1;
+    arp_notes[key] = notes[key];
+  }
+  arp_keys = keys;
+  // The first press starts the pattern right away; later ones join it.
+  if (keys != 0 && arp_mode != ARP_OFF && arp_event == 0)
+    arp_event = schedulerIn(0, arpStepCallback, NULL);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file arpeggiator.h
+ * @brief Arpeggiator over the held keys, on the tick scheduler.
+ *
+ * While a mode is selected, held keys no longer sound by themselves: the
+ * arpeggiator plays their notes (as chosen when each key was pressed, so a
+ * layout or tuning change mid-pattern leaves them alone) one at a time,
+ * ARP_STEPS_PER_BEAT steps per metronome beat (metronome.h), in pitch order.
+ * It starts on the first press and stops once every key is released.
+ */
+#ifndef ARPEGGIATOR_H
+#define ARPEGGIATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Steps per beat (4: sixteenth notes).
+ */
+#ifndef ARP_STEPS_PER_BEAT
+#define ARP_STEPS_PER_BEAT 4
+#endif
+
+/**
+ * @brief Share of each step the note sounds (1-100).
+ */
+#ifndef ARP_GATE_PERCENT
+#define ARP_GATE_PERCENT 50
+#endif
+
+/**
+ * @brief Velocity of arpeggiated notes.
+ */
+#ifndef ARP_VELOCITY
+#define ARP_VELOCITY 100
+#endif
+
+/**
+ * @brief Note orders.
+ */
+typedef enum
+{
+  ARP_OFF,      //!< Keys play normally
+  ARP_UP,       //!< Lowest to highest, then again
+  ARP_DOWN,     //!< Highest to lowest, then again
+  ARP_UP_DOWN,  //!< Up, then back down, not repeating the ends
+  ARP_MODE_COUNT
+} ArpMode;
+
+/**
+ * @brief Plays an arpeggiated note (scheduler IRQ context).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ */
+typedef void (*ArpNoteFn)(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Sets the note callback; the arpeggiator starts off.
+ * @param play Callback for notes
+ */
+void initArp(ArpNoteFn play);
+
+/**
+ * @brief Selects the note order; ARP_OFF stops the arpeggiator.
+ */
+void arpSetMode(ArpMode mode);
+
+/**
+ * @brief The selected note order.
+ */
+ArpMode arpMode(void);
+
+/**
+ * @brief Short name of a mode, for the console.
+ */
+const char *arpModeName(ArpMode mode);
+
+/**
+ * @brief Hands the arpeggiator the held keys; call after every scan with
+ * key events.
+ * @param keys Debounced key bitmap (bit = row * 4 + col)
+ * @param notes MIDI note each key started on its press, by key index; read
+ * only for keys newly set in keys
+ */
+void arpSetKeys(uint16_t keys, const uint8_t *notes);
+
+#endif // ARPEGGIATOR_H
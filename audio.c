@@ -0,0 +1,259 @@
+/**
+ * @file audio.c
+ * @brief Front end of the synthesizer and its audio output.
+ */
+#include "audio.h"
+#include "hot_path.h"
+#include "audio_out.h"
+#include "event_queue.h"
+#include "latency.h"
+#include "notes.h"
+#include "sampler.h"
+#include "synth.h"
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/sync.h"
+
+// Period of one block; a rendered block starts playing after the blocks
+// queued before it, the DMA buffer waiting to play and the one playing now.
+#define AUDIO_BLOCK_US ((uint32_t)((uint64_t)AUDIO_BLOCK_SAMPLES * 1000000 / SYNTH_SAMPLE_RATE))
+
+static EventQueue audio_events;
+static bool audio_wake_pending = false;
+static uint32_t audio_last_render_us;
+static bool audio_rendered = false;
+static volatile bool audio_use_sampler = false;
+
+/**
+ * @brief Sample of the block being rendered at which an event takes effect.
+ *
+ * The block covers the events queued since the previous render, shifted one
+ * block period later, so an event keeps its spacing from its neighbours
+ * instead of snapping to the block boundary.
+ */
+static uint32_t HOT_PATH_FUNC(audioEventOffset)(const NoteEvent *event, uint32_t window_start_us, uint32_t count)
+{
+#if AUDIO_SAMPLE_ACCURATE
+  int32_t since_us = (int32_t)(event->time_us - window_start_us);
+  if (since_us <= 0)
+    return 0;
+  uint32_t offset = (uint32_t)(((uint64_t)since_us * SYNTH_SAMPLE_RATE) / 1000000);
+  return offset < count ? offset : count - 1;
+#else
+  (void)event;
+  (void)window_start_us;
+  (void)count;
+  return 0;
+#endif
+}
+
+/**
+ * @brief Renders the synthesizer (and sample voices) into part of a block.
+ */
+static inline void audioRenderSegment(int16_t *samples, uint32_t count)
+{
+  synthRenderBlock(samples, count);
+#if PIANO_SAMPLER
+  samplerRenderBlock(samples, count);
+#endif
+}
+
+/**
+ * @brief Block callback: renders up to each queued note event, applies it,
+ * then renders the rest of the block.
+ *
+ * The synthesizer is only ever touched from here (core 1's thread loop, or
+ * the audio DMA IRQ in single-core builds), so it needs no locking.
+ */
+static void HOT_PATH_FUNC(audioRender)(int16_t *samples, uint32_t count)
+{
+  // When the first sample of this block reaches the output.
+  uint32_t now = time_us_32();
+  uint32_t audio_start_us = now + (audioOutQueuedBlocks() + 2) * AUDIO_BLOCK_US;
+  uint32_t window_start_us = audio_rendered ? audio_last_render_us : now - AUDIO_BLOCK_US;
+  audio_last_render_us = now;
+  audio_rendered = true;
+
+  uint32_t done = 0;
+  NoteEvent event;
+  while (eventQueuePop(&audio_events, &event))
+  {
+    uint32_t offset = audioEventOffset(&event, window_start_us, count);
+    if (offset > done)
+    {
+      audioRenderSegment(samples + done, offset - done);
+      done = offset;
+    }
+
+    if (event.type == NOTE_EVENT_ON)
+    {
+      uint32_t sound_us = audio_start_us + (uint32_t)(((uint64_t)done * 1000000) / SYNTH_SAMPLE_RATE);
+#if PIANO_SAMPLER
+      if (audio_use_sampler)
+        samplerNoteOn(event.id, event.note, event.velocity);
+      else
+#endif
+        synthNoteOn(event.id, noteEntry(event.note)->phase_inc, event.velocity);
+      latencyRecord(LATENCY_ENQUEUE_TO_AUDIO, sound_us - event.time_us);
+      latencyRecord(LATENCY_KEY_TO_SOUND, sound_us - event.time_us + event.lead_us);
+      if (event.flags & NOTE_EVENT_FLAG_WAKE)
+        latencyRecord(LATENCY_WAKE_TO_SOUND, sound_us - event.time_us + event.lead_us);
+    }
+    else
+    {
+      synthNoteOff(event.id);
+#if PIANO_SAMPLER
+      samplerNoteOff(event.id);
+#endif
+    }
+  }
+  audioRenderSegment(samples + done, count - done);
+}
+
+/**
+ * @brief Starts the synthesizer and its output on the calling core.
+ */
+static void audioStart(void)
+{
+  initSynth();
+#if PIANO_SAMPLER
+  initSampler();
+#endif
+  initAudioOut(SYNTH_SAMPLE_RATE, audioRender, !AUDIO_DUAL_CORE);
+}
+
+#if AUDIO_DUAL_CORE
+/**
+ * @brief Core 1 entry point: renders blocks whenever the DMA IRQ has taken
+ * one from the queue, and sleeps otherwise.
+ *
+ * Rendering in thread mode rather than in the IRQ lets a late block be
+ * detected and replaced (audio_out.h) instead of playing half-rendered.
+ */
+static void audioCore1Main(void)
+{
+  // Lets core 0 pause this core while it writes flash (recorder.h).
+  flash_safe_execute_core_init();
+  audioStart();
+  while (true)
+  {
+    audioOutService();
+
+    // With interrupts masked, __wfi still wakes on one but its handler only
+    // runs after the idle time is taken, so IRQ time counts as busy. Checking
+    // for work with them masked means a refill can't slip in unnoticed.
+    uint32_t status = save_and_disable_interrupts();
+    if (!audioOutRenderPending())
+    {
+      uint32_t idle_start = time_us_32();
+      __wfi();
+      telemetryIdle(1, time_us_32() - idle_start);
+    }
+    restore_interrupts(status);
+  }
+}
+#endif
+
+/**
+ * @brief Timestamps and queues an event without blocking the scanner.
+ */
+static void HOT_PATH_FUNC(audioPost)(uint8_t type, uint8_t id, uint8_t note, uint8_t velocity,
+                                     uint32_t detected_us)
+{
+  uint32_t now = time_us_32();
+  uint32_t lead_us = now - detected_us;
+  NoteEvent event = {
+      .time_us = now,
+      .lead_us = (uint16_t)(lead_us < 0xFFFF ? lead_us : 0xFFFF),
+      .type = type,
+      .id = id,
+      .note = note,
+      .flags = 0,
+      .velocity = velocity,
+  };
+  if (type == NOTE_EVENT_ON && audio_wake_pending)
+  {
+    event.flags |= NOTE_EVENT_FLAG_WAKE;
+    audio_wake_pending = false;
+  }
+
+  // Producers may run in thread and IRQ context on core 0 (scanner, USB-MIDI
+  // input); keep the queue and the core 0 latency stage single-producer by
+  // not letting them interleave.
+  uint32_t status = save_and_disable_interrupts();
+  eventQueuePush(&audio_events, &event);
+  if (type == NOTE_EVENT_ON)
+    latencyRecord(LATENCY_DETECT_TO_ENQUEUE, lead_us);
+  restore_interrupts(status);
+}
+
+void initAudio(void)
+{
+  eventQueueInit(&audio_events);
+#if AUDIO_DUAL_CORE
+  multicore_launch_core1(audioCore1Main);
+#else
+  audioStart();
+#endif
+}
+
+void audioSuspend(void)
+{
+  audioOutPause();
+}
+
+void audioResume(void)
+{
+  audioOutResume();
+  audio_wake_pending = true;
+}
+
+void audioFlashBegin(void)
+{
+  audioOutPause();
+#if PIANO_SAMPLER
+  // The lockout can land mid-refill: the XIP stream must not be reading
+  // flash while it is erased or programmed.
+  samplerStreamPause();
+#endif
+}
+
+void audioFlashEnd(void)
+{
+#if PIANO_SAMPLER
+  samplerStreamResume();
+#endif
+  audioOutResume();
+}
+
+void audioNoteOn(uint8_t id, uint8_t midi_note, uint8_t velocity, uint32_t detected_us)
+{
+  audioPost(NOTE_EVENT_ON, id, midi_note, velocity, detected_us);
+}
+
+void audioNoteOff(uint8_t id, uint32_t detected_us)
+{
+  audioPost(NOTE_EVENT_OFF, id, 0, 0, detected_us);
+}
+
+void audioUseSampler(bool enable)
+{
+  audio_use_sampler = PIANO_SAMPLER && enable;
+}
+
+bool audioUsingSampler(void)
+{
+  return audio_use_sampler;
+}
+
+uint32_t audioDroppedEvents(void)
+{
+  return eventQueueOverflows(&audio_events);
+}
+
+const EventQueue *audioEventQueue(void)
+{
+  return &audio_events;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file audio.h
+ * @brief Front end of the synthesizer and its audio output.
+ *
+ * Note calls only timestamp an event and push it onto a lock-free queue; the
+ * audio block IRQ drains it before rendering. With AUDIO_DUAL_CORE, core 1
+ * owns the synthesizer and the DMA audio output, so keypad scanning on core 0
+ * and sample rendering never compete for the same CPU.
+ */
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "event_queue.h"
+
+/**
+ * @brief 1 to render audio on core 1.
+ */
+#ifndef AUDIO_DUAL_CORE
+#define AUDIO_DUAL_CORE 1
+#endif
+
+/**
+ * @brief 1 to apply each note event at the sample matching its timestamp
+ * rather than at the start of the next block.
+ */
+#ifndef AUDIO_SAMPLE_ACCURATE
+#define AUDIO_SAMPLE_ACCURATE 1
+#endif
+
+/**
+ * @brief 1 if the build links a recording for the sample voices (sampler.h).
+ */
+#ifndef PIANO_SAMPLER
+#define PIANO_SAMPLER 0
+#endif
+
+/**
+ * @brief Starts the synthesizer and audio output (launching core 1 if used).
+ */
+void initAudio(void);
+
+/**
+ * @brief Stops the audio output before the system clock is lowered.
+ *
+ * Voices should already be silent; the output resumes where it stopped.
+ */
+void audioSuspend(void);
+
+/**
+ * @brief Restarts the audio output once the system clock is back.
+ *
+ * The next note on is also recorded as LATENCY_WAKE_TO_SOUND.
+ */
+void audioResume(void);
+
+/**
+ * @brief Quiets the audio side for a flash erase or program.
+ *
+ * The output is paused: with the audio core locked out nothing refills the
+ * DMA blocks, which would otherwise replay stale samples for the whole write.
+ * With the sampler, its flash stream is also left idle (samplerStreamPause()).
+ */
+void audioFlashBegin(void);
+
+/**
+ * @brief Restarts the audio output after audioFlashBegin().
+ */
+void audioFlashEnd(void);
+
+/**
+ * @brief Starts a note.
+ * @param id Caller-chosen note identifier (e.g. key index)
+ * @param midi_note MIDI note number, played in the active tuning (notes.h)
+ * @param velocity MIDI velocity 1..127
+ * @param detected_us time_us_32() when the key press was first seen
+ */
+void audioNoteOn(uint8_t id, uint8_t midi_note, uint8_t velocity, uint32_t detected_us);
+
+/**
+ * @brief Releases a note started with audioNoteOn().
+ * @param id Note identifier
+ * @param detected_us time_us_32() when the key release was first seen
+ */
+void audioNoteOff(uint8_t id, uint32_t detected_us);
+
+/**
+ * @brief Plays notes started from now on with the sample voices instead of
+ * the synthesizer (PIANO_SAMPLER builds only).
+ *
+ * A single store, so it may be called from either core; sounding notes
+ * finish on the engine that started them.
+ */
+void audioUseSampler(bool enable);
+
+/**
+ * @brief Whether new notes use the sample voices.
+ */
+bool audioUsingSampler(void);
+
+/**
+ * @brief Number of note events dropped because the queue was full.
+ */
+uint32_t audioDroppedEvents(void);
+
+/**
+ * @brief The note event queue, for diagnostics (fill level, peak, overflows).
+ */
+const EventQueue *audioEventQueue(void);
+
+#endif // AUDIO_H
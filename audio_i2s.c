@@ -0,0 +1,39 @@
+/**
+ * @file audio_i2s.c
+ * @brief Output device for audio_out.h: an external I2S DAC driven by PIO.
+ */
+#include "audio_i2s.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "audio_i2s.pio.h"
+
+static PIO audio_i2s_pio;
+static uint audio_i2s_sm;
+
+uint initAudioI2s(uint sample_rate, volatile void **dma_target)
+{
+  // pio0 also runs the keypad scanner; the program is only 8 instructions.
+  audio_i2s_pio = pio0;
+  audio_i2s_sm = (uint)pio_claim_unused_sm(audio_i2s_pio, true);
+  uint offset = pio_add_program(audio_i2s_pio, &audio_i2s_program);
+
+  float clkdiv = (float)clock_get_hz(clk_sys) / ((float)sample_rate * AUDIO_I2S_CYCLES_PER_FRAME);
+  audio_i2s_program_init(audio_i2s_pio, audio_i2s_sm, offset, AUDIO_I2S_DATA_PIN,
+                         AUDIO_I2S_CLOCK_PIN_BASE, clkdiv);
+
+  *dma_target = &audio_i2s_pio->txf[audio_i2s_sm];
+  return pio_get_dreq(audio_i2s_pio, audio_i2s_sm, true);
+}
+
+void audioI2sPause(void)
+{
+  // A stopped state machine stops draining its FIFO, so the DMA stalls
+  // mid-block and no more block IRQs fire.
+  pio_sm_set_enabled(audio_i2s_pio, audio_i2s_sm, false);
+}
+
+void audioI2sResume(void)
+{
+  pio_sm_set_enabled(audio_i2s_pio, audio_i2s_sm, true);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file audio_i2s.h
+ * @brief Output device for audio_out.h: an external I2S DAC driven by PIO.
+ *
+ * A PIO state machine (audio_i2s.pio) generates BCLK, LRCLK and the data line
+ * for a 16-bit stereo DAC such as a PCM5102A or MAX98357A. Its clock divider
+ * sets the sample rate, and its TX FIFO paces the audio DMA, so no DMA timer
+ * is needed and the CPU is never involved per sample. The mono mix goes to
+ * both channels at full 16-bit resolution.
+ */
+#ifndef AUDIO_I2S_H
+#define AUDIO_I2S_H
+
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief GPIO carrying the I2S data line (DIN on the DAC).
+ */
+#ifndef AUDIO_I2S_DATA_PIN
+#define AUDIO_I2S_DATA_PIN 2
+#endif
+
+/**
+ * @brief GPIO for BCLK; LRCLK is on the next pin.
+ */
+#ifndef AUDIO_I2S_CLOCK_PIN_BASE
+#define AUDIO_I2S_CLOCK_PIN_BASE 3
+#endif
+
+/**
+ * @brief One stereo frame as the DMA writes it to the PIO TX FIFO.
+ */
+typedef uint32_t AudioI2sWord;
+
+/**
+ * @brief Converts a signed sample to a frame with it on both channels.
+ */
+static inline AudioI2sWord audioI2sEncode(int32_t sample)
+{
+  return (uint32_t)(uint16_t)sample * 0x10001u;
+}
+
+/**
+ * @brief Starts the I2S clocks and returns how the audio DMA reaches them.
+ * @param sample_rate Output rate in Hz
+ * @param dma_target Set to the register each frame is written to
+ * @return DREQ pacing the audio DMA
+ */
+uint initAudioI2s(uint sample_rate, volatile void **dma_target);
+
+/**
+ * @brief Stops the state machine, and with it BCLK and LRCLK.
+ */
+void audioI2sPause(void);
+
+/**
+ * @brief Restarts the state machine where it stopped.
+ */
+void audioI2sResume(void);
+
+#endif // AUDIO_I2S_H
@@ -0,0 +1,177 @@
+/**
+ * @file audio_out.c
+ * @brief DMA-fed block audio output, on the buzzer PWM or an external I2S
+ * DAC.
+ */
+#include "audio_out.h"
+#include "hot_path.h"
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// The output device only supplies the word the DMA writes per sample, the
+// DREQ pacing it and the register it is written to; the rest is shared.
+#if AUDIO_OUTPUT == AUDIO_OUTPUT_I2S
+#include "audio_i2s.h"
+typedef AudioI2sWord AudioOutWord;
+#define audioOutEncode audioI2sEncode
+#define audioOutDeviceInit initAudioI2s
+#define audioOutDevicePause audioI2sPause
+#define audioOutDeviceResume audioI2sResume
+#elif AUDIO_OUTPUT == AUDIO_OUTPUT_PWM
+#include "audio_pwm.h"
+typedef AudioPwmWord AudioOutWord;
+#define audioOutEncode audioPwmEncode
+#define audioOutDeviceInit initAudioPwm
+#define audioOutDevicePause audioPwmPause
+#define audioOutDeviceResume audioPwmResume
+#else
+#error "AUDIO_OUTPUT must be AUDIO_OUTPUT_PWM or AUDIO_OUTPUT_I2S"
+#endif
+
+#define AUDIO_DMA_IRQ DMA_IRQ_0
+
+static AudioRenderFn audio_render;
+static bool audio_render_in_irq;
+static uint audio_dma[2];
+static AudioOutWord audio_blocks[2][AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
+// Rendered blocks waiting for a DMA buffer. The renderer only advances the
+// head and the IRQ only the tail, so on one core neither needs a lock.
+static AudioOutWord audio_queue[AUDIO_QUEUE_BLOCKS][AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+static int16_t audio_queue_last[AUDIO_QUEUE_BLOCKS];
+static volatile uint32_t audio_queue_head = 0;
+static volatile uint32_t audio_queue_tail = 0;
+static volatile uint32_t audio_depth = AUDIO_QUEUE_DEPTH;
+static uint32_t audio_clean_blocks = 0;
+static int16_t audio_last_sample = 0;
+
+uint32_t HOT_PATH_FUNC(audioOutQueuedBlocks)(void)
+{
+  return audio_queue_head - audio_queue_tail;
+}
+
+bool HOT_PATH_FUNC(audioOutRenderPending)(void)
+{
+  return audioOutQueuedBlocks() < audio_depth;
+}
+
+uint32_t audioOutDepth(void)
+{
+  return audio_depth;
+}
+
+void HOT_PATH_FUNC(audioOutService)(void)
+{
+  while (audioOutRenderPending())
+  {
+    uint32_t slot = audio_queue_head % AUDIO_QUEUE_BLOCKS;
+    AudioOutWord *block = audio_queue[slot];
+    int16_t *samples = (int16_t *)block;
+    audio_render(samples, AUDIO_BLOCK_SAMPLES);
+    audio_queue_last[slot] = samples[AUDIO_BLOCK_SAMPLES - 1];
+    // Converted in place to output words. A word is at least as wide as a
+    // sample, so going backwards never overwrites a sample not yet read.
+    for (uint i = AUDIO_BLOCK_SAMPLES; i-- > 0;)
+      block[i] = audioOutEncode(samples[i]);
+    audio_queue_head++;
+  }
+}
+
+/**
+ * @brief Loads a DMA buffer with the next queued block, or on an underrun
+ * with a fade from the last sample played to silence.
+ */
+static void HOT_PATH_FUNC(audioLoadBlock)(AudioOutWord *block)
+{
+  if (audioOutQueuedBlocks() > 0)
+  {
+    uint32_t slot = audio_queue_tail % AUDIO_QUEUE_BLOCKS;
+    const AudioOutWord *queued = audio_queue[slot];
+    for (uint i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+      block[i] = queued[i];
+    audio_last_sample = audio_queue_last[slot];
+    audio_queue_tail++;
+    telemetryCount(TELEMETRY_AUDIO_BLOCKS);
+#if AUDIO_ADAPTIVE_DEPTH
+    if (audio_depth > AUDIO_QUEUE_DEPTH && ++audio_clean_blocks >= AUDIO_DEPTH_SHRINK_BLOCKS)
+    {
+      audio_depth--;
+      audio_clean_blocks = 0;
+    }
+#endif
+    return;
+  }
+
+  int32_t from = audio_last_sample;
+  for (uint i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    block[i] = audioOutEncode(from - from * (int32_t)(i + 1) / AUDIO_BLOCK_SAMPLES);
+  audio_last_sample = 0;
+  telemetryCount(TELEMETRY_AUDIO_UNDERRUNS);
+#if AUDIO_ADAPTIVE_DEPTH
+  if (audio_depth < AUDIO_QUEUE_BLOCKS)
+    audio_depth++;
+  audio_clean_blocks = 0;
+#endif
+}
+
+/**
+ * @brief A block finished playing (the other channel took over): reload it.
+ */
+static void HOT_PATH_FUNC(audioDmaIrqHandler)(void)
+{
+  for (uint b = 0; b < 2; b++)
+  {
+    if (!dma_channel_get_irq0_status(audio_dma[b]))
+      continue;
+    dma_channel_acknowledge_irq0(audio_dma[b]);
+    dma_channel_set_read_addr(audio_dma[b], audio_blocks[b], false);
+    audioLoadBlock(audio_blocks[b]);
+  }
+  if (audio_render_in_irq)
+    audioOutService();
+}
+
+void initAudioOut(uint sample_rate, AudioRenderFn render, bool render_in_irq)
+{
+  audio_render = render;
+  audio_render_in_irq = render_in_irq;
+
+  volatile void *target;
+  uint dreq = audioOutDeviceInit(sample_rate, &target);
+  audio_dma[0] = (uint)dma_claim_unused_channel(true);
+  audio_dma[1] = (uint)dma_claim_unused_channel(true);
+
+  for (uint b = 0; b < 2; b++)
+  {
+    dma_channel_config c = dma_channel_get_default_config(audio_dma[b]);
+    channel_config_set_transfer_data_size(&c, sizeof(AudioOutWord) == 4 ? DMA_SIZE_32 : DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dreq);
+    channel_config_set_chain_to(&c, audio_dma[b ^ 1]);
+    dma_channel_configure(audio_dma[b], &c, target, audio_blocks[b], AUDIO_BLOCK_SAMPLES, false);
+    dma_channel_set_irq0_enabled(audio_dma[b], true);
+  }
+  for (uint b = 0; b < 2; b++)
+  {
+    audioOutService();
+    audioLoadBlock(audio_blocks[b]);
+  }
+  audioOutService();
+
+  irq_set_exclusive_handler(AUDIO_DMA_IRQ, audioDmaIrqHandler);
+  irq_set_enabled(AUDIO_DMA_IRQ, true);
+  dma_channel_start(audio_dma[0]);
+}
+
+void audioOutPause(void)
+{
+  audioOutDevicePause();
+}
+
+void audioOutResume(void)
+{
+  audioOutDeviceResume();
+}
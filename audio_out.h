@@ -0,0 +1,136 @@
+/**
+ * @file audio_out.h
+ * @brief DMA-fed block audio output, on the buzzer PWM or an external I2S
+ * DAC.
+ *
+ * Two DMA channels alternately stream two sample blocks to the output
+ * selected at build time with AUDIO_OUTPUT: the buzzer PWM compare register
+ * (audio_pwm.h), paced by a DMA timer at the sample rate, or a PIO I2S
+ * transmitter (audio_i2s.h), paced by its FIFO. When a block has been played
+ * its channel raises an IRQ, which reloads it from a short queue of rendered
+ * blocks while the other one plays.
+ *
+ * Blocks are rendered into the queue by audioOutService(), from the IRQ
+ * itself or from a thread loop on the audio core. If a refill finds the queue
+ * empty (an underrun), the block fades the last sample to silence instead of
+ * replaying stale data. With AUDIO_ADAPTIVE_DEPTH, each underrun also raises
+ * the number of blocks rendered ahead, and a long run without one lowers it
+ * again to win the latency back.
+ */
+#ifndef AUDIO_OUT_H
+#define AUDIO_OUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief Output devices for AUDIO_OUTPUT.
+ */
+#define AUDIO_OUTPUT_PWM 0 //!< Buzzer, PWM duty modulation (audio_pwm.h)
+#define AUDIO_OUTPUT_I2S 1 //!< External DAC over PIO I2S (audio_i2s.h)
+
+#ifndef AUDIO_OUTPUT
+#define AUDIO_OUTPUT AUDIO_OUTPUT_PWM
+#endif
+
+/**
+ * @brief Samples per DMA block; output latency is two blocks plus the queue
+ * depth.
+ */
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 64
+#endif
+
+/**
+ * @brief Queue depth (blocks rendered ahead) at start-up, and the least the
+ * adaptive depth shrinks back to.
+ */
+#ifndef AUDIO_QUEUE_DEPTH
+#define AUDIO_QUEUE_DEPTH 1
+#endif
+
+/**
+ * @brief Most blocks the queue holds (the adaptive depth's ceiling).
+ */
+#ifndef AUDIO_QUEUE_BLOCKS
+#define AUDIO_QUEUE_BLOCKS 4
+#endif
+
+/**
+ * @brief 1 to deepen the queue after an underrun and shrink it again after
+ * AUDIO_DEPTH_SHRINK_BLOCKS blocks without one.
+ */
+#ifndef AUDIO_ADAPTIVE_DEPTH
+#define AUDIO_ADAPTIVE_DEPTH 1
+#endif
+
+/**
+ * @brief Clean blocks before the adaptive depth drops by one (4096 blocks is
+ * about 10 s at the default rate and block size).
+ */
+#ifndef AUDIO_DEPTH_SHRINK_BLOCKS
+#define AUDIO_DEPTH_SHRINK_BLOCKS 4096
+#endif
+
+#if AUDIO_QUEUE_DEPTH < 1 || AUDIO_QUEUE_DEPTH > AUDIO_QUEUE_BLOCKS
+#error "AUDIO_QUEUE_DEPTH must be between 1 and AUDIO_QUEUE_BLOCKS"
+#endif
+
+/**
+ * @brief Renders one block of signed 16-bit samples.
+ *
+ * Called from audioOutService(); a block that is not ready when the DMA
+ * needs it is replaced, so a late render only costs that block.
+ */
+typedef void (*AudioRenderFn)(int16_t *samples, uint32_t count);
+
+/**
+ * @brief Starts streaming rendered blocks to the output.
+ *
+ * Call on the core that will render; the queue is filled before output starts.
+ * @param sample_rate Output rate in Hz
+ * @param render Callback filling each block
+ * @param render_in_irq true to render from the DMA IRQ, false if the caller
+ * runs audioOutService() from a thread loop instead
+ */
+void initAudioOut(uint sample_rate, AudioRenderFn render, bool render_in_irq);
+
+/**
+ * @brief Renders blocks until the queue is at its current depth.
+ *
+ * With render_in_irq false, call it from the audio core's thread loop each
+ * time it wakes up; the loop may sleep while audioOutRenderPending() is false.
+ */
+void audioOutService(void);
+
+/**
+ * @brief Whether the queue is below its depth.
+ */
+bool audioOutRenderPending(void);
+
+/**
+ * @brief Blocks rendered and waiting in the queue.
+ */
+uint32_t audioOutQueuedBlocks(void);
+
+/**
+ * @brief Current queue depth target in blocks.
+ */
+uint32_t audioOutDepth(void);
+
+/**
+ * @brief Stops the output clock; the DMA simply stalls where it is.
+ *
+ * Safe to call from the other core. Both outputs are clocked from clk_sys,
+ * so pause before changing that clock.
+ */
+void audioOutPause(void);
+
+/**
+ * @brief Restarts output after audioOutPause() (clk_sys must be back to the
+ * rate it had at initAudioOut()).
+ */
+void audioOutResume(void);
+
+#endif // AUDIO_OUT_H
@@ -0,0 +1,83 @@
+/**
+ * @file audio_pwm.c
+ * @brief Output device for audio_out.h: the buzzer, through PWM duty
+ * modulation.
+ */
+#include "audio_pwm.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+
+#define AUDIO_PWM_MID (1u << (AUDIO_PWM_BITS - 1))
+
+static uint audio_timer;
+static uint16_t audio_timer_num, audio_timer_den;
+
+/**
+ * @brief Programs a DMA pacing timer to tick at sample_rate.
+ *
+ * The timer ticks at clk_sys * num / den with 16-bit num and den; the closest
+ * fraction is searched once here.
+ */
+static uint audioClaimPacingTimer(uint sample_rate)
+{
+  uint timer = (uint)dma_claim_unused_timer(true);
+  uint64_t clock = clock_get_hz(clk_sys);
+  uint32_t best_num = 1, best_den = 0;
+  uint64_t best_err = 0;
+
+  for (uint32_t num = 1; num <= 0xFFFF; num++)
+  {
+    uint64_t den = (clock * num + sample_rate / 2) / sample_rate;
+    if (den > 0xFFFF)
+      break;
+    uint64_t rate_x = clock * num;
+    uint64_t target = (uint64_t)sample_rate * den;
+    uint64_t err = rate_x > target ? rate_x - target : target - rate_x;
+    if (best_den == 0 || err * best_den < best_err * den)
+    {
+      best_num = num;
+      best_den = (uint32_t)den;
+      best_err = err;
+      if (err == 0)
+        break;
+    }
+  }
+
+  audio_timer_num = (uint16_t)best_num;
+  audio_timer_den = (uint16_t)best_den;
+  dma_timer_set_fraction(timer, audio_timer_num, audio_timer_den);
+  return timer;
+}
+
+uint initAudioPwm(uint sample_rate, volatile void **dma_target)
+{
+  gpio_set_function(AUDIO_PWM_PIN, GPIO_FUNC_PWM);
+  uint slice = pwm_gpio_to_slice_num(AUDIO_PWM_PIN);
+  pwm_config config = pwm_get_default_config();
+  pwm_config_set_clkdiv_int(&config, 1);
+  pwm_config_set_wrap(&config, (1u << AUDIO_PWM_BITS) - 1);
+  pwm_init(slice, &config, true);
+  pwm_set_gpio_level(AUDIO_PWM_PIN, AUDIO_PWM_MID);
+
+  // 16-bit writes to the compare register are replicated to both halves,
+  // so the block drives whichever channel (A or B) the buzzer pin is on.
+  *dma_target = &pwm_hw->slice[slice].cc;
+  audio_timer = audioClaimPacingTimer(sample_rate);
+  return dma_get_timer_dreq(audio_timer);
+}
+
+void audioPwmPause(void)
+{
+  // With a zero rate the timer never requests: the DMA stalls mid-block and
+  // no more block IRQs fire.
+  dma_timer_set_fraction(audio_timer, 0, 1);
+  pwm_set_gpio_level(AUDIO_PWM_PIN, 0);
+}
+
+void audioPwmResume(void)
+{
+  pwm_set_gpio_level(AUDIO_PWM_PIN, AUDIO_PWM_MID);
+  dma_timer_set_fraction(audio_timer, audio_timer_num, audio_timer_den);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file audio_pwm.h
+ * @brief Output device for audio_out.h: the buzzer, through PWM duty
+ * modulation.
+ *
+ * The buzzer PWM runs at a fixed ultrasonic carrier and every sample sets its
+ * duty cycle, so any waveform (and any number of mixed voices) can be played.
+ * A DMA timer paces the audio DMA at the sample rate.
+ */
+#ifndef AUDIO_PWM_H
+#define AUDIO_PWM_H
+
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief GPIO driving the buzzer (BitDogLab buzzer A).
+ */
+#ifndef AUDIO_PWM_PIN
+#define AUDIO_PWM_PIN 21
+#endif
+
+/**
+ * @brief Duty resolution; the carrier is clk_sys / 2^AUDIO_PWM_BITS.
+ */
+#ifndef AUDIO_PWM_BITS
+#define AUDIO_PWM_BITS 10
+#endif
+
+/**
+ * @brief One PWM compare value as the DMA writes it.
+ */
+typedef uint16_t AudioPwmWord;
+
+/**
+ * @brief Converts a signed sample to a compare value around mid duty.
+ */
+static inline AudioPwmWord audioPwmEncode(int32_t sample)
+{
+  return (uint16_t)((sample + 32768) >> (16 - AUDIO_PWM_BITS));
+}
+
+/**
+ * @brief Starts the carrier and the pacing timer, and returns how the audio
+ * DMA reaches them.
+ * @param sample_rate Output rate in Hz
+ * @param dma_target Set to the register each compare value is written to
+ * @return DREQ pacing the audio DMA
+ */
+uint initAudioPwm(uint sample_rate, volatile void **dma_target);
+
+/**
+ * @brief Stops the sample clock and drives the pin low.
+ */
+void audioPwmPause(void);
+
+/**
+ * @brief Restarts the sample clock and returns the pin to mid duty.
+ */
+void audioPwmResume(void);
+
+#endif // AUDIO_PWM_H
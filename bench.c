@@ -0,0 +1,237 @@
+/**
+ * @file bench.c
+ * @brief Benchmark of the scan-to-sound pipeline.
+ */
+#include "bench.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "debounce.h"
+#include "event_queue.h"
+#include "keypad_events.h"
+#include "keymap.h"
+#include "keypad_velocity.h"
+#include "notes.h"
+
+#define BENCH_BLOCK_US ((uint32_t)((uint64_t)AUDIO_BLOCK_SAMPLES * 1000000 / SYNTH_SAMPLE_RATE))
+
+static void benchStatInit(BenchStat *stat)
+{
+  stat->count = 0;
+  stat->total = 0;
+  stat->min = UINT32_MAX;
+  stat->max = 0;
+}
+
+static void benchStatAdd(BenchStat *stat, uint32_t cycles)
+{
+  stat->count++;
+  stat->total += cycles;
+  if (cycles < stat->min)
+    stat->min = cycles;
+  if (cycles > stat->max)
+    stat->max = cycles;
+}
+
+/**
+ * @brief Scanner side of one scan, as in the firmware main loop.
+ */
+static void benchScan(uint16_t raw, uint32_t now_us, Debouncer *debouncer,
+                      KeypadVelocity *velocity, uint16_t *keys, EventQueue *queue)
+{
+  KeypadEvents events;
+  uint16_t settled_keys = debouncer->state;
+  uint16_t debounced = debounceUpdate(debouncer, raw);
+  keypadVelocityScan(velocity, raw, settled_keys, debounceCounting(debouncer), now_us);
+  if (!keypadEventsUpdate(keys, debounced, &events))
+    return;
+
+  for (uint8_t i = 0; i < events.release_count; i++)
+  {
+    NoteEvent event = {.time_us = now_us, .type = NOTE_EVENT_OFF, .id = events.release_list[i]};
+    eventQueuePush(queue, &event);
+  }
+  for (uint8_t i = 0; i < events.press_count; i++)
+  {
+    uint8_t key = events.press_list[i];
+    NoteEvent event = {
+        .time_us = now_us,
+        .type = NOTE_EVENT_ON,
+        .id = key,
+        .note = keymapNote(key),
+        .velocity = keypadVelocityPress(velocity, key, now_us),
+    };
+    eventQueuePush(queue, &event);
+  }
+}
+
+/**
+ * @brief Audio side of one block, as in the firmware block callback.
+ */
+static void benchRender(EventQueue *queue, int16_t *block, BenchRenderer renderer,
+                        BenchResult *result)
+{
+  NoteEvent event;
+  while (eventQueuePop(queue, &event))
+  {
+    if (event.type == NOTE_EVENT_ON)
+    {
+      synthNoteOn(event.id, noteEntry(event.note)->phase_inc, event.velocity);
+      result->note_on++;
+    }
+    else
+    {
+      synthNoteOff(event.id);
+      result->note_off++;
+    }
+  }
+  if (renderer == BENCH_RENDER_BLOCK)
+  {
+    synthRenderBlock(block, AUDIO_BLOCK_SAMPLES);
+    return;
+  }
+  for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    block[i] = synthRenderSample();
+}
+
+void benchRun(const BenchTraceEntry *trace, uint32_t count, SynthWaveform waveform,
+              BenchRenderer renderer, const BenchClock *clock, BenchResult *result)
+{
+  static EventQueue queue;
+  Debouncer debouncer;
+  KeypadVelocity velocity;
+  uint16_t keys = 0;
+  int16_t block[AUDIO_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
+  benchStatInit(&result->scan);
+  benchStatInit(&result->render);
+  result->samples = 0;
+  result->note_on = 0;
+  result->note_off = 0;
+  result->peak_voices = 0;
+  result->audio_hash = 2166136261u;
+  if (count == 0)
+    return;
+
+  initSynth();
+  synthSetWaveform(waveform);
+  keymapSelect(KEYMAP_MAJOR);
+  eventQueueInit(&queue);
+  debounceInit(&debouncer, DEBOUNCE_PRESS_SCANS, DEBOUNCE_RELEASE_SCANS);
+  keypadVelocityInit(&velocity);
+
+  uint32_t start_us = trace[0].time_us;
+  uint32_t end_us = trace[count - 1].time_us + BENCH_TAIL_US;
+  uint32_t next_block_us = start_us;
+  uint32_t entry = 0;
+
+  for (uint32_t now_us = start_us; (int32_t)(end_us - now_us) > 0; now_us += BENCH_SCAN_PERIOD_US)
+  {
+    while (entry + 1 < count && (int32_t)(trace[entry + 1].time_us - now_us) <= 0)
+      entry++;
+
+    uint32_t begin = clock->read();
+    benchScan(trace[entry].raw, now_us, &debouncer, &velocity, &keys, &queue);
+    benchStatAdd(&result->scan, (clock->read() - begin) & clock->mask);
+
+    while ((int32_t)(now_us - next_block_us) >= 0)
+    {
+      begin = clock->read();
+      benchRender(&queue, block, renderer, result);
+      benchStatAdd(&result->render, (clock->read() - begin) & clock->mask);
+
+      for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+      {
+        uint16_t sample = (uint16_t)block[i];
+        result->audio_hash = (result->audio_hash ^ (sample & 0xFF)) * 16777619u;
+        result->audio_hash = (result->audio_hash ^ (sample >> 8)) * 16777619u;
+      }
+      result->samples += AUDIO_BLOCK_SAMPLES;
+      if (synthActiveVoices() > result->peak_voices)
+        result->peak_voices = synthActiveVoices();
+      next_block_us += BENCH_BLOCK_US;
+    }
+  }
+  result->dropped = eventQueueOverflows(&queue);
+}
+
+/**
+ * @brief Appends a press of keys with contact bounce, held for hold_us.
+ */
+static uint32_t benchPress(BenchTraceEntry *trace, uint32_t n, uint32_t capacity, uint32_t *time_us,
+                           uint16_t keys, uint32_t bounce_us, uint32_t hold_us)
+{
+  // Bounce: alternating contact and gap, each bounce_us / 4 long.
+  static const uint16_t pattern[] = {1, 0, 1, 0, 1};
+  for (uint32_t i = 0; i < sizeof(pattern) / sizeof(pattern[0]) && n < capacity; i++)
+  {
+    trace[n++] = (BenchTraceEntry){*time_us, pattern[i] ? keys : 0};
+    *time_us += bounce_us / 4;
+  }
+  *time_us += hold_us;
+  for (uint32_t i = 0; i < 3 && n < capacity; i++)
+  {
+    trace[n++] = (BenchTraceEntry){*time_us, (i & 1) ? keys : 0};
+    *time_us += bounce_us / 4;
+  }
+  *time_us += 50000; // Rest, so the next press starts from a settled release
+  return n;
+}
+
+uint32_t benchSyntheticTrace(BenchTraceEntry *trace, uint32_t capacity)
+{
+  uint32_t n = 0;
+  uint32_t time_us = 0;
+
+  // Two octaves of single notes, bounce growing from clean to sloppy.
+  for (uint32_t key = 0; key < KEYPAD_MATRIX_KEYS; key++)
+    n = benchPress(trace, n, capacity, &time_us, (uint16_t)(1u << key), 400 + key * 600, 120000);
+
+  // Chords of up to four keys, one per row, overlapping the voice limit.
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    uint16_t chord = (uint16_t)((1u << (i % 4)) | (1u << (4 + (i + 1) % 4)) |
+                                (1u << (8 + (i + 2) % 4)) | (1u << (12 + (i + 3) % 4)));
+    n = benchPress(trace, n, capacity, &time_us, chord, 2000, 250000);
+  }
+  return n;
+}
+
+void benchPrintHeader(void)
+{
+  printf("%-10s %8s %8s %8s %8s %8s %10s %6s %6s %8s\n", "waveform", "scan avg", "scan max",
+         "blk avg", "blk max", "blk min", "samples/s", "notes", "peak", "hash");
+}
+
+void benchPrint(const char *name, const BenchResult *result, uint64_t cycles_per_second)
+{
+  uint64_t scan_avg = result->scan.count ? result->scan.total / result->scan.count : 0;
+  uint64_t render_avg = result->render.count ? result->render.total / result->render.count : 0;
+  uint64_t samples_per_second =
+      result->render.total ? (uint64_t)result->samples * cycles_per_second / result->render.total : 0;
+
+  printf("%-10s %8" PRIu64 " %8" PRIu32 " %8" PRIu64 " %8" PRIu32 " %8" PRIu32 " %10" PRIu64
+         " %6" PRIu32 " %6" PRIu32 " %08" PRIx32 "\n",
+         name, scan_avg, result->scan.max, render_avg, result->render.max,
+         result->render.count ? result->render.min : 0, samples_per_second, result->note_on,
+         result->peak_voices, result->audio_hash);
+  if (result->dropped)
+    printf("  %" PRIu32 " events dropped\n", result->dropped);
+}
+
+bool benchCompare(const char *name, const BenchTraceEntry *trace, uint32_t count,
+                  SynthWaveform waveform, const BenchClock *clock, uint64_t cycles_per_second)
+{
+  BenchResult block;
+  BenchResult reference;
+  benchRun(trace, count, waveform, BENCH_RENDER_BLOCK, clock, &block);
+  benchRun(trace, count, waveform, BENCH_RENDER_SAMPLE, clock, &reference);
+  benchPrint(name, &block, cycles_per_second);
+  benchPrint("  ref", &reference, cycles_per_second);
+
+  if (block.audio_hash != reference.audio_hash)
+  {
+    printf("  %s: block output differs from the per-sample reference\n", name);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file bench.h
+ * @brief Benchmark of the scan-to-sound pipeline, shared by the host
+ * simulation (host/) and the on-target benchmark build (bench_target.c).
+ *
+ * A key trace (times at which the raw matrix bitmap changes) is replayed
+ * through the same modules the firmware uses: debouncer, velocity capture,
+ * key event extraction and the SPSC event queue on the scanner side; note
+ * handling and block rendering on the audio side. Both sides are timed with
+ * a caller-supplied cycle counter. A hash of the rendered audio catches
+ * changes in behaviour, not just in speed.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "synth.h"
+
+/**
+ * @brief Scan period of the simulated main loop (us).
+ */
+#ifndef BENCH_SCAN_PERIOD_US
+#define BENCH_SCAN_PERIOD_US 1000
+#endif
+
+/**
+ * @brief Block size of the simulated audio side; matches audio_out.h, which
+ * is not included here because it needs the SDK.
+ */
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 64
+#endif
+
+/**
+ * @brief Silence rendered after the last trace entry, for releases (us).
+ */
+#define BENCH_TAIL_US 500000
+
+/**
+ * @brief How the audio side renders each block.
+ */
+typedef enum
+{
+  BENCH_RENDER_BLOCK,   //!< synthRenderBlock(), as the firmware does
+  BENCH_RENDER_SAMPLE,  //!< synthRenderSample() per sample: the reference
+} BenchRenderer;
+
+/**
+ * @brief One trace entry: the raw key bitmap from time_us on.
+ */
+typedef struct
+{
+  uint32_t time_us;
+  uint16_t raw;
+} BenchTraceEntry;
+
+/**
+ * @brief Free-running cycle counter.
+ */
+typedef struct
+{
+  uint32_t (*read)(void);  //!< Current count (counting up)
+  uint32_t mask;           //!< Counter width, e.g. 0xFFFFFF for SysTick
+} BenchClock;
+
+/**
+ * @brief Cycle statistics of one pipeline stage.
+ */
+typedef struct
+{
+  uint32_t count;
+  uint64_t total;
+  uint32_t min;
+  uint32_t max;
+} BenchStat;
+
+/**
+ * @brief Outcome of one run.
+ */
+typedef struct
+{
+  BenchStat scan;        //!< Cycles per scan (debounce + events + queue)
+  BenchStat render;      //!< Cycles per audio block (events + synth)
+  uint32_t samples;      //!< Samples rendered
+  uint32_t note_on;      //!< Note ons reaching the synth
+  uint32_t note_off;     //!< Note offs reaching the synth
+  uint32_t peak_voices;  //!< Most voices sounding at once
+  uint32_t dropped;      //!< Events lost to a full queue
+  uint32_t audio_hash;   //!< FNV-1a of every rendered sample
+} BenchResult;
+
+/**
+ * @brief Replays a trace through the pipeline.
+ * @param trace Entries in time order
+ * @param count Number of entries
+ * @param waveform Synth waveform to render with
+ * @param renderer Block or per-sample reference rendering; both must give
+ * the same audio hash
+ * @param clock Cycle counter for the timings
+ * @param result Receives the statistics
+ */
+void benchRun(const BenchTraceEntry *trace, uint32_t count, SynthWaveform waveform,
+              BenchRenderer renderer, const BenchClock *clock, BenchResult *result);
+
+/**
+ * @brief Fills a trace with bouncy scales and chords.
+ *
+ * Deterministic, so host and target runs are comparable.
+ * @param trace Receives the entries
+ * @param capacity Entries available
+ * @return Entries written
+ */
+uint32_t benchSyntheticTrace(BenchTraceEntry *trace, uint32_t capacity);
+
+/**
+ * @brief Prints a result as one table row.
+ * @param name Row label
+ * @param result Result of benchRun()
+ * @param cycles_per_second Counter rate, for samples/second
+ */
+void benchPrint(const char *name, const BenchResult *result, uint64_t cycles_per_second);
+
+/**
+ * @brief Prints the header matching benchPrint() rows.
+ */
+void benchPrintHeader(void);
+
+/**
+ * @brief Runs one waveform with the block renderer and the per-sample
+ * reference and prints both rows, flagging any difference in the output.
+ * @param name Waveform label
+ * @param trace Entries in time order
+ * @param count Number of entries
+ * @param waveform Synth waveform to render with
+ * @param clock Cycle counter for the timings
+ * @param cycles_per_second Counter rate, for samples/second
+ * @return true if both renderers produced the same audio
+ */
+bool benchCompare(const char *name, const BenchTraceEntry *trace, uint32_t count,
+                  SynthWaveform waveform, const BenchClock *clock, uint64_t cycles_per_second);
+
+#endif // BENCH_H
@@ -0,0 +1,67 @@
+/**
+ * @file bench_target.c
+ * @brief On-target front end of the pipeline benchmark (see bench.h).
+ *
+ * Built as FirstHDMI_bench with -DPIANO_BENCHMARK=ON. Replays the synthetic
+ * trace through the firmware's own scanner and synth code, timed with the
+ * SysTick counter at clk_sys, and prints a block and a per-sample reference
+ * row per waveform over USB stdio every few seconds. The figures include the
+ * XIP cache, SRAM placement and interpolator effects the host simulation
+ * cannot show.
+ */
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "bench.h"
+
+/**
+ * @brief Seconds between benchmark passes.
+ */
+#ifndef BENCH_REPEAT_S
+#define BENCH_REPEAT_S 5
+#endif
+
+#define SYSTICK_MASK 0x00FFFFFFu
+
+static BenchTraceEntry trace[512];
+
+static const char *const waveform_names[SYNTH_WAVE_COUNT] = {"square", "sine", "triangle", "saw",
+                                                             "piano"};
+
+/**
+ * @brief SysTick counts down from its reload value; flip it to count up.
+ */
+static uint32_t systickCycles(void)
+{
+  return SYSTICK_MASK - systick_hw->cvr;
+}
+
+static void initSystick(void)
+{
+  systick_hw->csr = 0;
+  systick_hw->rvr = SYSTICK_MASK;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS; // clk_sys, no IRQ
+}
+
+int main()
+{
+  stdio_init_all();
+  initSystick();
+
+  const BenchClock clock = {systickCycles, SYSTICK_MASK};
+  uint32_t count = benchSyntheticTrace(trace, sizeof(trace) / sizeof(trace[0]));
+
+  while (true)
+  {
+    sleep_ms(BENCH_REPEAT_S * 1000);
+    printf("\n%lu trace entries, %d voices, %d Hz, %d-sample blocks, clk_sys %lu Hz (SysTick cycles)\n",
+           (unsigned long)count, SYNTH_MAX_VOICES, SYNTH_SAMPLE_RATE, AUDIO_BLOCK_SAMPLES,
+           (unsigned long)clock_get_hz(clk_sys));
+    benchPrintHeader();
+    for (int waveform = 0; waveform < SYNTH_WAVE_COUNT; waveform++)
+      benchCompare(waveform_names[waveform], trace, count, (SynthWaveform)waveform, &clock,
+                   clock_get_hz(clk_sys));
+  }
+}
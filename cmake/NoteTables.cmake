@@ -0,0 +1,139 @@
+# Generates the flash-resident note tables (see notes.h) at configure time.
+#
+# For every supported tuning and every MIDI note in NOTE_MIDI_FIRST..LAST the
+# generator computes, with CMake's 64-bit integer math:
+#   - the synthesizer phase increment at the configured sample rate
+#   - the tone engine PWM divider (8.4 fixed point) and wrap at clk_sys
+# so the note-on path never divides at runtime.
+#
+# Usage: piano_generate_note_tables(<target> <sample_rate_hz> <sys_clk_hz>)
+
+set(NOTE_MIDI_FIRST 24) # C1
+set(NOTE_MIDI_LAST 108) # C8
+
+# 2^(k/12) * 1e9, k = 0..11
+set(_NOTE_ET_RATIOS
+    1000000000 1059463094 1122462048 1189207115 1259921050 1334839854
+    1414213562 1498307077 1587401052 1681792831 1781797436 1887748625)
+
+# 5-limit just intonation over C, as numerator/denominator pairs
+set(_NOTE_JUST_NUM 1 16 9 6 5 4 45 3 8 5 9 15)
+set(_NOTE_JUST_DEN 1 15 8 5 4 3 32 2 5 3 5 8)
+
+# Splits <delta> semitones into octave (floored) and semitone within octave.
+function(_note_split delta out_octave out_semitone)
+  if(delta LESS 0)
+    math(EXPR octave "-((11 - (${delta})) / 12)")
+  else()
+    math(EXPR octave "${delta} / 12")
+  endif()
+  math(EXPR semitone "${delta} - 12 * (${octave})")
+  set(${out_octave} ${octave} PARENT_SCOPE)
+  set(${out_semitone} ${semitone} PARENT_SCOPE)
+endfunction()
+
+# Scales <value> by 2^octave.
+function(_note_octave value octave out)
+  if(octave LESS 0)
+    math(EXPR shift "-(${octave})")
+    math(EXPR value "${value} >> ${shift}")
+  else()
+    math(EXPR value "${value} << ${octave}")
+  endif()
+  set(${out} ${value} PARENT_SCOPE)
+endfunction()
+
+# Equal temperament frequency in micro-Hz of MIDI <note> for A4 = <a4_hz>.
+function(_note_equal_uhz note a4_hz out)
+  math(EXPR delta "${note} - 69")
+  _note_split(${delta} octave semitone)
+  list(GET _NOTE_ET_RATIOS ${semitone} ratio)
+  math(EXPR uhz "${a4_hz} * 1000000 * ${ratio} / 1000000000")
+  _note_octave(${uhz} ${octave} uhz)
+  set(${out} ${uhz} PARENT_SCOPE)
+endfunction()
+
+# Just intonation frequency in micro-Hz of MIDI <note>, C4 taken from A4 = 440.
+function(_note_just_uhz note out)
+  _note_equal_uhz(60 440 c4)
+  math(EXPR delta "${note} - 60")
+  _note_split(${delta} octave semitone)
+  list(GET _NOTE_JUST_NUM ${semitone} num)
+  list(GET _NOTE_JUST_DEN ${semitone} den)
+  math(EXPR uhz "${c4} * ${num} / ${den}")
+  _note_octave(${uhz} ${octave} uhz)
+  set(${out} ${uhz} PARENT_SCOPE)
+endfunction()
+
+# One "{phase_inc, pwm_div16, pwm_top}" initializer for a frequency.
+function(_note_entry uhz sample_rate sys_clk out)
+  # phase_inc = f * 2^32 / rate, split in two steps to stay within 64 bits
+  math(EXPR scaled "${uhz} * 65536")
+  math(EXPR q "${scaled} / ${sample_rate}")
+  math(EXPR r "${scaled} % ${sample_rate}")
+  math(EXPR phase_inc "(${q} * 65536 + ${r} * 65536 / ${sample_rate}) / 1000000")
+  if(phase_inc GREATER 4294967295)
+    set(phase_inc 4294967295)
+  endif()
+
+  # Smallest divider that keeps the wrap within 16 bits
+  math(EXPR clk16 "${sys_clk} * 16 * 1000000")
+  math(EXPR div16 "(${clk16} + ${uhz} * 65536 - 1) / (${uhz} * 65536)")
+  if(div16 LESS 16)
+    set(div16 16)
+  elseif(div16 GREATER 4095)
+    set(div16 4095)
+  endif()
+  math(EXPR top "(${clk16} + ${div16} * ${uhz} / 2) / (${div16} * ${uhz}) - 1")
+  if(top GREATER 65535)
+    set(top 65535)
+  endif()
+
+  set(${out} "{${phase_inc}u, ${div16}, ${top}}" PARENT_SCOPE)
+endfunction()
+
+function(piano_generate_note_tables target sample_rate sys_clk)
+  set(out_dir ${CMAKE_CURRENT_BINARY_DIR}/generated)
+  set(out_file ${out_dir}/note_tables.c)
+
+  set(tunings "TUNING_EQUAL_440" "TUNING_EQUAL_432" "TUNING_JUST_C")
+  set(body "")
+  foreach(tuning IN LISTS tunings)
+    string(APPEND body "    [${tuning}] = {\n")
+    foreach(note RANGE ${NOTE_MIDI_FIRST} ${NOTE_MIDI_LAST})
+      if(tuning STREQUAL "TUNING_EQUAL_440")
+        _note_equal_uhz(${note} 440 uhz)
+      elseif(tuning STREQUAL "TUNING_EQUAL_432")
+        _note_equal_uhz(${note} 432 uhz)
+      else()
+        _note_just_uhz(${note} uhz)
+      endif()
+      _note_entry(${uhz} ${sample_rate} ${sys_clk} entry)
+      string(APPEND body "        ${entry}, // MIDI ${note}, ${uhz} uHz\n")
+    endforeach()
+    string(APPEND body "    },\n")
+  endforeach()
+
+  set(content "// Generated by cmake/NoteTables.cmake - do not edit.\n")
+  string(APPEND content "#include \"notes.h\"\n#include \"synth.h\"\n\n")
+  # Checked against the rate the synthesizer itself is built for, and the
+  # note range notes.h declares the table with.
+  string(APPEND content "#if SYNTH_SAMPLE_RATE != ${sample_rate}\n")
+  string(APPEND content "#error \"note_tables.c was generated for a different SYNTH_SAMPLE_RATE\"\n#endif\n")
+  string(APPEND content "#if NOTE_MIDI_FIRST != ${NOTE_MIDI_FIRST} || NOTE_MIDI_LAST != ${NOTE_MIDI_LAST}\n")
+  string(APPEND content "#error \"note_tables.c was generated for a different note range\"\n#endif\n\n")
+  string(APPEND content "const NoteEntry note_tables[TUNING_COUNT][NOTE_COUNT] = {\n${body}};\n")
+
+  # Only touch the file when it changes, so unrelated reconfigures don't rebuild it
+  if(EXISTS ${out_file})
+    file(READ ${out_file} previous)
+  endif()
+  if(NOT "${previous}" STREQUAL "${content}")
+    file(WRITE ${out_file} "${content}")
+  endif()
+
+  target_sources(${target} PRIVATE ${out_file})
+  target_compile_definitions(${target} PRIVATE
+      NOTE_MIDI_FIRST=${NOTE_MIDI_FIRST}
+      NOTE_MIDI_LAST=${NOTE_MIDI_LAST})
+endfunction()
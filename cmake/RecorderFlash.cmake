@@ -0,0 +1,31 @@
+# Keeps the program image out of the flash area the recorder saves takes to.
+#
+# recorder.c stores a take in the last sectors of flash: a 16-byte header
+# followed by the ring, rounded up to whole 4 KB sectors. Nothing in the SDK
+# linker script knows about that area, so as the binary (or the linked
+# sampler data) grows it could silently overlap it. This writes a small
+# linker script, added to the link next to the SDK's, whose ASSERT fails the
+# link instead.
+#
+# Usage: piano_reserve_recorder_flash(<target> <ring_bytes>)
+
+function(piano_reserve_recorder_flash target ring_bytes)
+  math(EXPR reserved "(16 + ${ring_bytes} + 4095) / 4096 * 4096")
+
+  set(out_file ${CMAKE_CURRENT_BINARY_DIR}/generated/recorder_flash.ld)
+  set(content "/* Generated by cmake/RecorderFlash.cmake - do not edit. */\n")
+  string(APPEND content "__recorder_flash_start = ORIGIN(FLASH) + LENGTH(FLASH) - ${reserved};\n")
+  string(APPEND content "ASSERT(__flash_binary_end <= __recorder_flash_start,\n")
+  string(APPEND content "       \"program image overlaps the ${reserved}-byte recorder flash area (RECORDER_RING_BYTES)\")\n")
+
+  # Only touch the file when it changes, so unrelated reconfigures don't relink
+  if(EXISTS ${out_file})
+    file(READ ${out_file} previous)
+  endif()
+  if(NOT "${previous}" STREQUAL "${content}")
+    file(WRITE ${out_file} "${content}")
+  endif()
+
+  target_link_options(${target} PRIVATE ${out_file})
+  set_property(TARGET ${target} APPEND PROPERTY LINK_DEPENDS ${out_file})
+endfunction()
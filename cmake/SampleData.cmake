@@ -0,0 +1,32 @@
+# Links a raw recording into flash for the sample voices (see sampler.h).
+#
+# The file is included verbatim with .incbin between the sampler_data and
+# sampler_data_end symbols, word aligned and padded to whole words as the
+# XIP streaming DMA reads 32-bit words. Editing the file relinks the target.
+#
+# Usage: piano_add_sample_data(<target> <file>)
+
+function(piano_add_sample_data target file)
+  get_filename_component(file ${file} ABSOLUTE)
+  if(NOT EXISTS ${file})
+    message(FATAL_ERROR "Sample file ${file} not found")
+  endif()
+
+  set(out_file ${CMAKE_CURRENT_BINARY_DIR}/generated/sampler_data.S)
+  set(content "// Generated by cmake/SampleData.cmake from ${file} - do not edit.\n")
+  string(APPEND content ".section .rodata.sampler_data, \"a\"\n")
+  string(APPEND content ".balign 4\n.global sampler_data\nsampler_data:\n")
+  string(APPEND content ".incbin \"${file}\"\n")
+  string(APPEND content ".balign 4\n.global sampler_data_end\nsampler_data_end:\n")
+
+  # Only touch the file when it changes, so unrelated reconfigures don't rebuild it
+  if(EXISTS ${out_file})
+    file(READ ${out_file} previous)
+  endif()
+  if(NOT "${previous}" STREQUAL "${content}")
+    file(WRITE ${out_file} "${content}")
+  endif()
+
+  set_source_files_properties(${out_file} PROPERTIES OBJECT_DEPENDS ${file})
+  target_sources(${target} PRIVATE ${out_file})
+endfunction()
@@ -0,0 +1,119 @@
+# RAM vs flash footprint report for a linked RP2040 executable.
+#
+# Included from CMakeLists.txt it defines
+#   piano_add_size_report(<target>)
+# which adds a <target>_size custom target. Building it runs this file again
+# in script mode on the ELF and prints, and writes to <target>.size.txt:
+#   - every allocated output section with its size, split into flash
+#     (loaded from XIP flash, including the load image of .data) and SRAM
+#   - every function linked into SRAM (the HOT_PATH_FUNC() / .time_critical
+#     code) with its size, largest first
+# The text file is stable across builds of the same code, so diffing it shows
+# which function grew or moved out of RAM.
+
+set(_PIANO_SIZE_REPORT_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+function(piano_add_size_report target)
+  add_custom_target(${target}_size
+      COMMAND ${CMAKE_COMMAND}
+          -DELF=$<TARGET_FILE:${target}>
+          -DOBJDUMP=${CMAKE_OBJDUMP}
+          -DNM=${CMAKE_NM}
+          -DOUT=$<TARGET_FILE_DIR:${target}>/${target}.size.txt
+          -P ${_PIANO_SIZE_REPORT_SCRIPT}
+      DEPENDS ${target}
+      COMMENT "RAM/flash footprint of ${target}"
+      VERBATIM)
+endfunction()
+
+if(NOT CMAKE_SCRIPT_MODE_FILE OR NOT DEFINED ELF)
+  return()
+endif()
+
+# RP2040 memory map: XIP flash at 0x1xxxxxxx, SRAM (and scratch X/Y) at
+# 0x2xxxxxxx.
+function(_size_region address out)
+  string(SUBSTRING "${address}" 0 1 first)
+  if(first STREQUAL "1")
+    set(${out} flash PARENT_SCOPE)
+  elseif(first STREQUAL "2")
+    set(${out} ram PARENT_SCOPE)
+  else()
+    set(${out} other PARENT_SCOPE)
+  endif()
+endfunction()
+
+# Left-pads <value> with spaces to <width> characters.
+function(_size_pad value width out)
+  string(LENGTH "${value}" len)
+  while(len LESS width)
+    string(PREPEND value " ")
+    math(EXPR len "${len} + 1")
+  endwhile()
+  set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+execute_process(COMMAND ${OBJDUMP} -h ${ELF}
+    OUTPUT_VARIABLE headers RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${OBJDUMP} -h ${ELF} failed")
+endif()
+
+# objdump -h prints each section on one line (Idx Name Size VMA LMA Off Algn)
+# followed by a line of flags.
+string(REPLACE "\n" ";" lines "${headers}")
+set(report "Sections (bytes):\n")
+set(flash_total 0)
+set(ram_total 0)
+set(section "")
+foreach(line IN LISTS lines)
+  if(line MATCHES "^ *[0-9]+ +([^ ]+) +([0-9a-f]+) +([0-9a-f]+) +([0-9a-f]+) ")
+    set(section ${CMAKE_MATCH_1})
+    math(EXPR size "0x${CMAKE_MATCH_2}")
+    set(vma ${CMAKE_MATCH_3})
+    set(lma ${CMAKE_MATCH_4})
+  elseif(section AND line MATCHES "ALLOC")
+    _size_region(${vma} run)
+    _size_region(${lma} load)
+    # .data and the RAM code run from SRAM but their image sits in flash.
+    if(load STREQUAL "flash" AND line MATCHES "LOAD")
+      math(EXPR flash_total "${flash_total} + ${size}")
+    endif()
+    if(run STREQUAL "ram")
+      math(EXPR ram_total "${ram_total} + ${size}")
+    endif()
+    _size_pad(${size} 8 padded)
+    string(APPEND report "  ${padded}  ${run}  ${section}\n")
+    set(section "")
+  else()
+    set(section "")
+  endif()
+endforeach()
+string(APPEND report "Flash: ${flash_total}\nRAM:   ${ram_total}\n\n")
+
+execute_process(COMMAND ${NM} -S --size-sort --reverse-sort ${ELF}
+    OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${NM} -S ${ELF} failed")
+endif()
+
+string(REPLACE "\n" ";" lines "${symbols}")
+set(code_total 0)
+set(code_report "")
+foreach(line IN LISTS lines)
+  if(line MATCHES "^([0-9a-f]+) ([0-9a-f]+) [tT] (.+)$")
+    _size_region(${CMAKE_MATCH_1} run)
+    if(run STREQUAL "ram")
+      math(EXPR size "0x${CMAKE_MATCH_2}")
+      math(EXPR code_total "${code_total} + ${size}")
+      _size_pad(${size} 8 padded)
+      string(APPEND code_report "  ${padded}  ${CMAKE_MATCH_3}\n")
+    endif()
+  endif()
+endforeach()
+string(APPEND report "Code in RAM (bytes): ${code_total}\n${code_report}")
+
+message("${report}")
+if(DEFINED OUT)
+  file(WRITE ${OUT} "${report}")
+endif()
@@ -0,0 +1,73 @@
+/**
+ * @file console.c
+ * @brief Single-key diagnostic commands over USB stdio.
+ */
+#include "console.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+/**
+ * @brief One registered command.
+ */
+typedef struct
+{
+  char key;
+  const char *help;
+  ConsoleHandler handler;
+} ConsoleCommand;
+
+static ConsoleCommand console_commands[CONSOLE_MAX_COMMANDS];
+static int console_command_count = 0;
+static void (*console_input_callback)(void) = NULL;
+
+bool consoleRegister(char key, const char *help, ConsoleHandler handler)
+{
+  if (console_command_count >= CONSOLE_MAX_COMMANDS)
+    return false;
+
+  console_commands[console_command_count++] = (ConsoleCommand){key, help, handler};
+  return true;
+}
+
+/**
+ * @brief stdio callback: forwards "input available" to the registered hook.
+ */
+static void consoleCharsAvailable(void *param)
+{
+  (void)param;
+  if (console_input_callback)
+    console_input_callback();
+}
+
+void consoleSetInputCallback(void (*fn)(void))
+{
+  console_input_callback = fn;
+  stdio_set_chars_available_callback(fn ? consoleCharsAvailable : NULL, NULL);
+}
+
+/**
+ * @brief Lists the registered commands.
+ */
+static void consoleHelp(void)
+{
+  for (int i = 0; i < console_command_count; i++)
+    printf("  %c  %s\n", console_commands[i].key, console_commands[i].help);
+}
+
+void consolePoll(void)
+{
+  int c;
+  while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+  {
+    if (c == '?')
+    {
+      consoleHelp();
+      continue;
+    }
+    for (int i = 0; i < console_command_count; i++)
+    {
+      if (console_commands[i].key == c)
+        console_commands[i].handler();
+    }
+  }
+}
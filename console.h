@@ -0,0 +1,47 @@
+/**
+ * @file console.h
+ * @brief Single-key diagnostic commands over USB stdio.
+ *
+ * Modules register a handler per command character; consolePoll() reads the
+ * pending input without blocking and runs the matching handlers. '?' lists
+ * the registered commands.
+ */
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Maximum number of registered commands.
+ */
+#ifndef CONSOLE_MAX_COMMANDS
+#define CONSOLE_MAX_COMMANDS 24
+#endif
+
+/**
+ * @brief Command handler.
+ */
+typedef void (*ConsoleHandler)(void);
+
+/**
+ * @brief Registers a command.
+ * @param key Character that runs the command
+ * @param help One-line description shown by '?'
+ * @param handler Function to run
+ * @return false if the command table is full
+ */
+bool consoleRegister(char key, const char *help, ConsoleHandler handler);
+
+/**
+ * @brief Calls fn (from IRQ context) whenever new input arrives.
+ *
+ * Lets a sleeping main loop wake up to run consolePoll().
+ */
+void consoleSetInputCallback(void (*fn)(void));
+
+/**
+ * @brief Runs the commands typed since the last call. Never blocks.
+ */
+void consolePoll(void);
+
+#endif // CONSOLE_H
@@ -0,0 +1,53 @@
+/**
+ * @file debounce.c
+ * @brief Per-key integrating debouncer for the 16-key matrix, bit-sliced.
+ */
+#include "debounce.h"
+#include "hot_path.h"
+
+/**
+ * @brief Limits a threshold to what the counters can reach.
+ */
+static uint8_t debounceClamp(uint8_t scans)
+{
+  if (scans < 1)
+    return 1;
+  return scans > DEBOUNCE_MAX_SCANS ? DEBOUNCE_MAX_SCANS : scans;
+}
+
+void debounceInit(Debouncer *debouncer, uint8_t press_scans, uint8_t release_scans)
+{
+  debouncer->state = 0;
+  for (int b = 0; b < DEBOUNCE_COUNTER_BITS; b++)
+    debouncer->count[b] = 0;
+  debouncer->press_scans = debounceClamp(press_scans);
+  debouncer->release_scans = debounceClamp(release_scans);
+}
+
+uint16_t HOT_PATH_FUNC(debounceUpdate)(Debouncer *debouncer, uint16_t raw)
+{
+  uint16_t state = debouncer->state;
+  uint16_t differ = raw ^ state;
+
+  // Ripple-carry increment of the keys that differ; the others restart at 0.
+  uint16_t carry = differ;
+  uint16_t reached = differ;
+  for (int b = 0; b < DEBOUNCE_COUNTER_BITS; b++)
+  {
+    uint16_t bit = (debouncer->count[b] & differ) ^ carry;
+    carry &= debouncer->count[b];
+    debouncer->count[b] = bit;
+
+    // Threshold bit b of each key: the press threshold for released keys,
+    // the release threshold for pressed ones.
+    uint16_t threshold = (uint16_t)(((debouncer->press_scans >> b) & 1 ? ~state : 0) |
+                                    ((debouncer->release_scans >> b) & 1 ? state : 0));
+    reached &= (uint16_t)~(bit ^ threshold);
+  }
+
+  // Keys whose counter hit their threshold flip and start counting afresh.
+  debouncer->state = state ^ reached;
+  for (int b = 0; b < DEBOUNCE_COUNTER_BITS; b++)
+    debouncer->count[b] &= (uint16_t)~reached;
+  return debouncer->state;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file debounce.h
+ * @brief Per-key integrating debouncer for the 16-key matrix, bit-sliced.
+ *
+ * Each key has a small counter of consecutive scans whose raw reading
+ * disagrees with its debounced state. A key changes state once its counter
+ * reaches the press threshold (going down) or the release threshold (going
+ * up); any scan that agrees with the state clears the counter, so bounce
+ * never accumulates. The counters are stored "vertically": bit b of every
+ * key's counter lives in one 16-bit word, so all keys are updated together
+ * with a handful of bitwise operations per scan and no loops over keys.
+ */
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Bits per key counter; thresholds can be 1 .. 2^bits - 1 scans.
+ */
+#define DEBOUNCE_COUNTER_BITS 3
+#define DEBOUNCE_MAX_SCANS ((1u << DEBOUNCE_COUNTER_BITS) - 1)
+
+/**
+ * @brief Consecutive scans a key must read down before it is pressed.
+ */
+#ifndef DEBOUNCE_PRESS_SCANS
+#define DEBOUNCE_PRESS_SCANS 2
+#endif
+
+/**
+ * @brief Consecutive scans a key must read up before it is released.
+ */
+#ifndef DEBOUNCE_RELEASE_SCANS
+#define DEBOUNCE_RELEASE_SCANS 4
+#endif
+
+/**
+ * @brief Debounced state of all keys.
+ */
+typedef struct
+{
+  uint16_t state;                          //!< Debounced key bitmap
+  uint16_t count[DEBOUNCE_COUNTER_BITS];   //!< Counter bit b of every key
+  uint8_t press_scans;                     //!< Press threshold
+  uint8_t release_scans;                   //!< Release threshold
+} Debouncer;
+
+/**
+ * @brief Resets all keys to released.
+ * @param debouncer Debouncer
+ * @param press_scans Press threshold, clamped to 1 .. DEBOUNCE_MAX_SCANS
+ * @param release_scans Release threshold, clamped to 1 .. DEBOUNCE_MAX_SCANS
+ */
+void debounceInit(Debouncer *debouncer, uint8_t press_scans, uint8_t release_scans);
+
+/**
+ * @brief Feeds one raw scan.
+ * @param debouncer Debouncer
+ * @param raw Raw key bitmap of this scan
+ * @return Debounced key bitmap
+ */
+uint16_t debounceUpdate(Debouncer *debouncer, uint16_t raw);
+
+/**
+ * @brief Debounced state as of the last debounceUpdate().
+ * @return Debounced key bitmap
+ */
+static inline uint16_t debounceState(const Debouncer *debouncer)
+{
+  return debouncer->state;
+}
+
+/**
+ * @brief Keys partway through a change.
+ * @return Bitmap of keys whose last raw reading disagreed with their state
+ */
+static inline uint16_t debounceCounting(const Debouncer *debouncer)
+{
+  uint16_t counting = 0;
+  for (int b = 0; b < DEBOUNCE_COUNTER_BITS; b++)
+    counting |= debouncer->count[b];
+  return counting;
+}
+
+/**
+ * @brief Checks whether no key is partway through a change.
+ * @return true if every raw reading agreed with the debounced state
+ */
+static inline bool debounceSettled(const Debouncer *debouncer)
+{
+  return debounceCounting(debouncer) == 0;
+}
+
+#endif // DEBOUNCE_H
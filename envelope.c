@@ -0,0 +1,131 @@
+/**
+ * @file envelope.c
+ * @brief Linear attack/decay/sustain/release envelope.
+ */
+#include "envelope.h"
+#include "hot_path.h"
+
+/**
+ * @brief Per-sample step covering span in the given time (at least one sample).
+ */
+static uint32_t envelopeStep(uint32_t span, uint32_t ms, uint32_t sample_rate)
+{
+  uint32_t samples = (uint32_t)(((uint64_t)ms * sample_rate) / 1000);
+  if (samples == 0)
+    samples = 1;
+  uint32_t step = span / samples;
+  return step > 0 ? step : 1;
+}
+
+void envelopeSetParams(EnvelopeParams *params, uint16_t peak, uint32_t attack_ms,
+                       uint32_t decay_ms, uint8_t sustain_percent, uint32_t release_ms,
+                       uint32_t sample_rate)
+{
+  if (sustain_percent > 100)
+    sustain_percent = 100;
+
+  params->peak = (uint32_t)peak << 16;
+  params->sustain = (uint32_t)(((uint64_t)params->peak * sustain_percent) / 100);
+  params->attack_step = envelopeStep(params->peak, attack_ms, sample_rate);
+  params->decay_step = envelopeStep(params->peak - params->sustain, decay_ms, sample_rate);
+  params->release_step = envelopeStep(params->peak, release_ms, sample_rate);
+}
+
+/**
+ * @brief Scales a level or step by gain / 128 without 64-bit math.
+ */
+static uint32_t envelopeScale(uint32_t value, uint32_t gain)
+{
+  uint32_t scaled = (value >> 7) * gain;
+  return scaled > 0 ? scaled : 1;
+}
+
+void envelopeScaleParams(EnvelopeParams *dst, const EnvelopeParams *src, uint32_t gain)
+{
+  dst->peak = envelopeScale(src->peak, gain);
+  dst->sustain = src->sustain > 0 ? envelopeScale(src->sustain, gain) : 0;
+  dst->attack_step = envelopeScale(src->attack_step, gain);
+  dst->decay_step = envelopeScale(src->decay_step, gain);
+  dst->release_step = envelopeScale(src->release_step, gain);
+}
+
+/**
+ * @brief Enters a linear stage from the current level toward target.
+ */
+static void HOT_PATH_FUNC(envelopeEnter)(Envelope *env, EnvelopeStage stage, uint32_t target, uint32_t step)
+{
+  env->stage = (uint8_t)stage;
+  if (target >= env->level)
+  {
+    env->step = (int32_t)step;
+    env->remaining = (target - env->level + step - 1) / step;
+  }
+  else
+  {
+    env->step = -(int32_t)step;
+    env->remaining = (env->level - target + step - 1) / step;
+  }
+}
+
+/**
+ * @brief Enters the stage after the one that just ran out.
+ */
+static void HOT_PATH_FUNC(envelopeNextStage)(Envelope *env, const EnvelopeParams *params)
+{
+  switch (env->stage)
+  {
+  case ENVELOPE_ATTACK:
+    env->level = params->peak;
+    envelopeEnter(env, ENVELOPE_DECAY, params->sustain, params->decay_step);
+    if (env->remaining > 0)
+      break;
+    // No decay phase
+    __attribute__((fallthrough));
+  case ENVELOPE_DECAY:
+    env->level = params->sustain;
+    env->stage = ENVELOPE_SUSTAIN;
+    env->step = 0;
+    env->remaining = UINT32_MAX;
+    if (params->sustain > 0)
+      break;
+    // Zero sustain ends the note
+    __attribute__((fallthrough));
+  default:
+    envelopeReset(env);
+    break;
+  }
+}
+
+void HOT_PATH_FUNC(envelopeGateOn)(Envelope *env, const EnvelopeParams *params)
+{
+  envelopeEnter(env, ENVELOPE_ATTACK, params->peak, params->attack_step);
+  if (env->remaining == 0)
+    envelopeNextStage(env, params);
+}
+
+void HOT_PATH_FUNC(envelopeGateOff)(Envelope *env, const EnvelopeParams *params)
+{
+  if (env->stage == ENVELOPE_IDLE)
+    return;
+  envelopeEnter(env, ENVELOPE_RELEASE, 0, params->release_step);
+  if (env->remaining == 0)
+    envelopeReset(env);
+}
+
+void HOT_PATH_FUNC(envelopeReset)(Envelope *env)
+{
+  env->stage = ENVELOPE_IDLE;
+  env->level = 0;
+  env->step = 0;
+  env->remaining = UINT32_MAX;
+}
+
+void HOT_PATH_FUNC(envelopeAdvance)(Envelope *env, const EnvelopeParams *params, uint32_t samples)
+{
+  if (env->remaining == UINT32_MAX)
+    return; // Sustain (or idle) never runs out
+
+  env->remaining -= samples;
+  if (env->remaining == 0)
+    envelopeNextStage(env, params);
+}
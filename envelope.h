@@ -0,0 +1,123 @@
+/**
+ * @file envelope.h
+ * @brief Linear attack/decay/sustain/release envelope, stepped per sample by
+ * addition only.
+ *
+ * An envelope is a sequence of linear segments. Each stage knows how many
+ * samples it has left, so the renderer asks for the next segment once per
+ * block (or sub-block), runs that many samples adding a constant step, and
+ * then advances the envelope. Stage changes therefore land on the exact
+ * sample, and the only per-block work is a comparison. Divisions happen only
+ * when the parameters are set or a gate changes.
+ *
+ * Levels are 16.16 fixed point; the integer part is the gain applied to a
+ * Q15 oscillator output.
+ */
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Envelope stages.
+ */
+typedef enum
+{
+  ENVELOPE_IDLE,
+  ENVELOPE_ATTACK,
+  ENVELOPE_DECAY,
+  ENVELOPE_SUSTAIN,
+  ENVELOPE_RELEASE,
+} EnvelopeStage;
+
+/**
+ * @brief Per-sample steps derived from the ADSR times.
+ */
+typedef struct
+{
+  uint32_t peak;          //!< Attack target level (16.16)
+  uint32_t sustain;       //!< Sustain level (16.16)
+  uint32_t attack_step;   //!< Level added per attack sample
+  uint32_t decay_step;    //!< Level removed per decay sample
+  uint32_t release_step;  //!< Level removed per release sample
+} EnvelopeParams;
+
+/**
+ * @brief State of one envelope.
+ */
+typedef struct
+{
+  uint32_t level;      //!< Current level (16.16)
+  int32_t step;        //!< Added to level every sample of this stage
+  uint32_t remaining;  //!< Samples left in this stage
+  uint8_t stage;       //!< EnvelopeStage
+} Envelope;
+
+/**
+ * @brief Derives the per-sample steps of an ADSR shape.
+ * @param params Receives the steps
+ * @param peak Peak gain (integer part of the 16.16 level)
+ * @param attack_ms Time from silence to peak
+ * @param decay_ms Time from peak to sustain
+ * @param sustain_percent Sustain level, percent of peak
+ * @param release_ms Time from peak to silence (shorter from lower levels)
+ * @param sample_rate Output sample rate in Hz
+ */
+void envelopeSetParams(EnvelopeParams *params, uint16_t peak, uint32_t attack_ms,
+                       uint32_t decay_ms, uint8_t sustain_percent, uint32_t release_ms,
+                       uint32_t sample_rate);
+
+/**
+ * @brief Scales an envelope shape's levels, keeping its times.
+ * @param dst Receives the scaled parameters
+ * @param src Parameters to scale
+ * @param gain Gain in 1/128 steps (128 = unchanged)
+ */
+void envelopeScaleParams(EnvelopeParams *dst, const EnvelopeParams *src, uint32_t gain);
+
+/**
+ * @brief Key down: attack from the current level, so a retrigger never clicks.
+ */
+void envelopeGateOn(Envelope *env, const EnvelopeParams *params);
+
+/**
+ * @brief Key up: release from the current level.
+ */
+void envelopeGateOff(Envelope *env, const EnvelopeParams *params);
+
+/**
+ * @brief Silences the envelope immediately.
+ */
+void envelopeReset(Envelope *env);
+
+/**
+ * @brief Samples that can be rendered with the current step.
+ * @param env Envelope
+ * @param max Samples wanted
+ * @return min(max, samples left in the current stage)
+ */
+static inline uint32_t envelopeSegment(const Envelope *env, uint32_t max)
+{
+  return env->remaining < max ? env->remaining : max;
+}
+
+/**
+ * @brief Moves the envelope forward after rendering a segment.
+ *
+ * The renderer has already added step to level for each rendered sample.
+ * @param env Envelope
+ * @param params Its parameters
+ * @param samples Samples rendered (at most envelopeSegment())
+ */
+void envelopeAdvance(Envelope *env, const EnvelopeParams *params, uint32_t samples);
+
+/**
+ * @brief Checks whether the envelope still produces sound.
+ */
+static inline bool envelopeActive(const Envelope *env)
+{
+  return env->stage != ENVELOPE_IDLE;
+}
+
+#endif // ENVELOPE_H
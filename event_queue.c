@@ -0,0 +1,62 @@
+/**
+ * @file event_queue.c
+ * @brief Lock-free single-producer single-consumer queue of note events.
+ */
+#include "event_queue.h"
+#include "hot_path.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+void eventQueueInit(EventQueue *queue)
+{
+  queue->head = 0;
+  queue->tail = 0;
+  queue->overflows = 0;
+  queue->peak = 0;
+}
+
+bool HOT_PATH_FUNC(eventQueuePush)(EventQueue *queue, const NoteEvent *event)
+{
+  uint32_t head = queue->head;
+  uint32_t used = head - queue->tail;
+
+  if (used >= EVENT_QUEUE_SIZE)
+  {
+    queue->overflows++;
+    return false;
+  }
+
+  queue->slots[head & EVENT_QUEUE_MASK] = *event;
+  // Publish the slot contents before the new head becomes visible.
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  queue->head = head + 1;
+
+  if (used + 1 > queue->peak)
+    queue->peak = used + 1;
+  return true;
+}
+
+bool HOT_PATH_FUNC(eventQueuePop)(EventQueue *queue, NoteEvent *event)
+{
+  uint32_t tail = queue->tail;
+
+  if (tail == queue->head)
+    return false;
+
+  // Read the slot only after observing the head that published it.
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  *event = queue->slots[tail & EVENT_QUEUE_MASK];
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  queue->tail = tail + 1;
+  return true;
+}
+
+uint32_t eventQueueCount(const EventQueue *queue)
+{
+  return queue->head - queue->tail;
+}
+
+uint32_t eventQueueOverflows(const EventQueue *queue)
+{
+  return queue->overflows;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file event_queue.h
+ * @brief Lock-free single-producer single-consumer queue of note events.
+ *
+ * Decouples the keypad scanner (producer) from the synthesizer (consumer).
+ * The producer only writes head, the consumer only writes tail, and both are
+ * word-sized, so the queue needs no locks and works between IRQ and thread
+ * context as well as between the two cores. There must be exactly one
+ * producer and one consumer at a time; several producers on one core must be
+ * serialized by the caller.
+ */
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Queue capacity in events (power of two).
+ */
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 64
+#endif
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0
+#error "EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Kinds of note event.
+ */
+typedef enum
+{
+  NOTE_EVENT_ON = 1,
+  NOTE_EVENT_OFF = 2,
+} NoteEventType;
+
+/**
+ * @brief Flags of a note event.
+ */
+typedef enum
+{
+  NOTE_EVENT_FLAG_WAKE = 0x01, //!< First note after waking from low-power idle
+} NoteEventFlag;
+
+/**
+ * @brief One timestamped note event (12 bytes, word-aligned).
+ */
+typedef struct __attribute__((aligned(4)))
+{
+  uint32_t time_us;   //!< time_us_32() when the event was queued
+  uint16_t lead_us;   //!< Time from detection (column edge or scan) to queueing, saturated
+  uint8_t type;       //!< NoteEventType
+  uint8_t id;         //!< Note identifier (e.g. key index)
+  uint8_t note;       //!< MIDI note number (note on only)
+  uint8_t flags;      //!< NoteEventFlag bits
+  uint8_t velocity;   //!< MIDI velocity 1..127 (note on only)
+} NoteEvent;
+
+/**
+ * @brief Ring storage and indices; indices run freely and wrap by mask.
+ */
+typedef struct
+{
+  NoteEvent slots[EVENT_QUEUE_SIZE];
+  volatile uint32_t head;       //!< Next slot to write (producer only)
+  volatile uint32_t tail;       //!< Next slot to read (consumer only)
+  volatile uint32_t overflows;  //!< Events dropped because the queue was full
+  volatile uint32_t peak;       //!< Highest fill level seen by the producer
+} EventQueue;
+
+/**
+ * @brief Empties the queue and clears its counters.
+ */
+void eventQueueInit(EventQueue *queue);
+
+/**
+ * @brief Appends an event (producer side).
+ * @return false if the queue was full; the event is dropped and counted
+ */
+bool eventQueuePush(EventQueue *queue, const NoteEvent *event);
+
+/**
+ * @brief Removes the oldest event (consumer side).
+ * @return false if the queue was empty
+ */
+bool eventQueuePop(EventQueue *queue, NoteEvent *event);
+
+/**
+ * @brief Number of events waiting.
+ */
+uint32_t eventQueueCount(const EventQueue *queue);
+
+/**
+ * @brief Total events dropped because the queue was full.
+ */
+uint32_t eventQueueOverflows(const EventQueue *queue);
+
+#endif // EVENT_QUEUE_H
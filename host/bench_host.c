@@ -0,0 +1,132 @@
+/**
+ * @file bench_host.c
+ * @brief Host front end of the pipeline benchmark (see bench.h).
+ *
+ * Usage: piano_bench [trace.txt]
+ *
+ * A trace has one "<time_us> <raw_hex>" entry per line, in time order, where
+ * raw is the key bitmap read from the matrix from that time on (bit n = key
+ * n, row-major); '#' starts a comment. Without a trace the synthetic one from
+ * benchSyntheticTrace() is replayed. Each waveform is run with the block
+ * renderer and the per-sample reference; the exit status is nonzero if their
+ * output differs.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TRACE_CAPACITY 65536
+
+static BenchTraceEntry trace[TRACE_CAPACITY];
+
+static const char *const waveform_names[SYNTH_WAVE_COUNT] = {"square", "sine", "triangle", "saw",
+                                                             "piano"};
+
+static uint64_t hostNanoseconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Cycle counter: the TSC where there is one, nanoseconds otherwise.
+ */
+static uint32_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  return (uint32_t)hostNanoseconds();
+#endif
+}
+
+/**
+ * @brief Reads a trace file.
+ * @return Entries read, or 0 on error
+ */
+static uint32_t readTrace(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+  {
+    perror(path);
+    return 0;
+  }
+
+  char line[128];
+  uint32_t count = 0;
+  uint32_t line_number = 0;
+  while (fgets(line, sizeof(line), file) && count < TRACE_CAPACITY)
+  {
+    unsigned long time_us;
+    unsigned int raw;
+    line_number++;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (sscanf(line, "%lu %x", &time_us, &raw) != 2 || raw > 0xFFFF ||
+        (count > 0 && time_us < trace[count - 1].time_us))
+    {
+      fprintf(stderr, "%s:%lu: bad entry\n", path, (unsigned long)line_number);
+      fclose(file);
+      return 0;
+    }
+    trace[count++] = (BenchTraceEntry){(uint32_t)time_us, (uint16_t)raw};
+  }
+  fclose(file);
+  return count;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t count;
+  if (argc > 1)
+  {
+    count = readTrace(argv[1]);
+    if (count == 0)
+      return EXIT_FAILURE;
+  }
+  else
+  {
+    count = benchSyntheticTrace(trace, TRACE_CAPACITY);
+  }
+
+  const BenchClock clock = {hostCycles, 0xFFFFFFFFu};
+  printf("%lu trace entries, %d voices, %d Hz, %d-sample blocks (times in %s)\n",
+         (unsigned long)count, SYNTH_MAX_VOICES, SYNTH_SAMPLE_RATE, AUDIO_BLOCK_SAMPLES,
+#if defined(__x86_64__) || defined(__i386__)
+         "TSC cycles"
+#else
+         "ns"
+#endif
+  );
+  benchPrintHeader();
+
+  bool identical = true;
+  for (int waveform = 0; waveform < SYNTH_WAVE_COUNT; waveform++)
+  {
+    // The counter rate is calibrated over the first run.
+    static uint64_t cycles_per_second;
+    if (cycles_per_second == 0)
+    {
+      BenchResult result;
+      uint64_t start_ns = hostNanoseconds();
+      uint32_t start_cycles = hostCycles();
+      benchRun(trace, count, (SynthWaveform)waveform, BENCH_RENDER_BLOCK, &clock, &result);
+      uint64_t elapsed_ns = hostNanoseconds() - start_ns;
+      uint32_t elapsed_cycles = hostCycles() - start_cycles;
+      cycles_per_second = elapsed_ns ? (uint64_t)elapsed_cycles * 1000000000u / elapsed_ns : 1;
+    }
+    identical &= benchCompare(waveform_names[waveform], trace, count, (SynthWaveform)waveform,
+                              &clock, cycles_per_second);
+  }
+  if (!identical)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
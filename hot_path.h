@@ -0,0 +1,30 @@
+/**
+ * @file hot_path.h
+ * @brief Places the audio and keypad inner loops in SRAM.
+ *
+ * Code normally executes in place from QSPI flash through the XIP cache, and
+ * a cache miss stalls the core for the tens of cycles a flash line fill
+ * takes. Functions defined with HOT_PATH_FUNC() go to a
+ * `.time_critical.<name>` section instead, which the SDK linker script copies
+ * into SRAM at boot, so their timing no longer depends on what else ran.
+ *
+ * The modules using this header stay free of SDK includes; off target (or with
+ * HOT_PATH_IN_RAM set to 0) the macro leaves the function where it was.
+ */
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+/**
+ * @brief 1 to link HOT_PATH_FUNC() functions into SRAM.
+ */
+#ifndef HOT_PATH_IN_RAM
+#define HOT_PATH_IN_RAM 1
+#endif
+
+#if HOT_PATH_IN_RAM && defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#define HOT_PATH_FUNC(name) __attribute__((section(".time_critical." #name))) name
+#else
+#define HOT_PATH_FUNC(name) name
+#endif
+
+#endif // HOT_PATH_H
@@ -0,0 +1,49 @@
+/**
+ * @file keymap.c
+ * @brief Key-to-note layouts of the 4x4 matrix.
+ */
+#include "keymap.h"
+
+const uint8_t keymap_tables[KEYMAP_COUNT][KEYPAD_MATRIX_KEYS] = {
+    [KEYMAP_MAJOR] = {60, 62, 64, 65, 67, 69, 71, 72, 74, 76, 77, 79, 81, 83, 84, 86},
+    [KEYMAP_MAJOR_LOW] = {48, 50, 52, 53, 55, 57, 59, 60, 62, 64, 65, 67, 69, 71, 72, 74},
+    [KEYMAP_MAJOR_HIGH] = {72, 74, 76, 77, 79, 81, 83, 84, 86, 88, 89, 91, 93, 95, 96, 98},
+    [KEYMAP_CHROMATIC] = {60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75},
+    [KEYMAP_MINOR] = {57, 59, 60, 62, 64, 65, 67, 69, 71, 72, 74, 76, 77, 79, 81, 83},
+    [KEYMAP_PENTATONIC] = {60, 62, 64, 67, 69, 72, 74, 76, 79, 81, 84, 86, 88, 91, 93, 96},
+    // Kick, side stick, snare, clap / toms / hi-hats / cymbals and bells.
+    [KEYMAP_DRUMS] = {36, 37, 38, 39, 41, 43, 45, 47, 42, 44, 46, 54, 49, 51, 53, 56},
+};
+
+static const char *const keymap_names[KEYMAP_COUNT] = {
+    [KEYMAP_MAJOR] = "major",
+    [KEYMAP_MAJOR_LOW] = "major -1 oct",
+    [KEYMAP_MAJOR_HIGH] = "major +1 oct",
+    [KEYMAP_CHROMATIC] = "chromatic",
+    [KEYMAP_MINOR] = "A minor",
+    [KEYMAP_PENTATONIC] = "pentatonic",
+    [KEYMAP_DRUMS] = "drums",
+};
+
+static const uint8_t *volatile keymap_active = keymap_tables[KEYMAP_MAJOR];
+
+void keymapSelect(KeymapLayout layout)
+{
+  if (layout < KEYMAP_COUNT)
+    keymap_active = keymap_tables[layout];
+}
+
+KeymapLayout keymapLayout(void)
+{
+  return (KeymapLayout)((keymap_active - keymap_tables[0]) / KEYPAD_MATRIX_KEYS);
+}
+
+const char *keymapName(KeymapLayout layout)
+{
+  return layout < KEYMAP_COUNT ? keymap_names[layout] : "?";
+}
+
+uint8_t keymapNote(uint8_t key)
+{
+  return keymap_active[key % KEYPAD_MATRIX_KEYS];
+}
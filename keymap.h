@@ -0,0 +1,70 @@
+/**
+ * @file keymap.h
+ * @brief Key-to-note layouts of the 4x4 matrix.
+ *
+ * Every layout is a 16-byte table of MIDI notes in flash; the pitch of each
+ * note comes from the active tuning (notes.h). Switching layouts only swaps
+ * the active table pointer, so it is a single store and safe from either core.
+ */
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <stdint.h>
+#include "keypad_events.h"
+
+/**
+ * @brief Available layouts.
+ */
+typedef enum
+{
+  KEYMAP_MAJOR,      //!< C major, C4-D6 (the original layout)
+  KEYMAP_MAJOR_LOW,  //!< C major an octave down, C3-D5
+  KEYMAP_MAJOR_HIGH, //!< C major an octave up, C5-D7
+  KEYMAP_CHROMATIC,  //!< Chromatic, C4-D#5
+  KEYMAP_MINOR,      //!< A natural minor, A3-B5
+  KEYMAP_PENTATONIC, //!< C major pentatonic, C4-E7
+  KEYMAP_DRUMS,      //!< General MIDI percussion notes, for a drum kit on the MIDI host
+  KEYMAP_COUNT
+} KeymapLayout;
+
+/**
+ * @brief Keys that, held together, switch to the next layout (the two
+ * bottom corners).
+ */
+#ifndef KEYMAP_NEXT_LAYOUT_COMBO
+#define KEYMAP_NEXT_LAYOUT_COMBO ((1u << 12) | (1u << 15))
+#endif
+
+/**
+ * @brief Keys that, held together, switch to the next tuning (the two top
+ * corners).
+ */
+#ifndef KEYMAP_NEXT_TUNING_COMBO
+#define KEYMAP_NEXT_TUNING_COMBO ((1u << 0) | (1u << 3))
+#endif
+
+extern const uint8_t keymap_tables[KEYMAP_COUNT][KEYPAD_MATRIX_KEYS];
+
+/**
+ * @brief Selects the layout used by keymapNote(). A single pointer store.
+ */
+void keymapSelect(KeymapLayout layout);
+
+/**
+ * @brief The active layout.
+ */
+KeymapLayout keymapLayout(void);
+
+/**
+ * @brief Short name of a layout, for the console.
+ */
+const char *keymapName(KeymapLayout layout);
+
+/**
+ * @brief Note assigned to a key in the active layout.
+ * @param key Key index (row * 4 + col)
+ * @return MIDI note number
+ */
+uint8_t keymapNote(uint8_t key);
+
+#endif // KEYMAP_H
@@ -0,0 +1,62 @@
+/**
+ * @file keypad_events.c
+ * @brief N-key rollover: turns raw matrix bitmaps into press/release events.
+ */
+#include "keypad_events.h"
+#include "hot_path.h"
+
+#define KEYPAD_ROW_BITS ((1u << KEYPAD_MATRIX_COLS) - 1)
+
+/**
+ * @brief Appends the indices of the set bits of mask to list, ascending.
+ */
+static uint8_t HOT_PATH_FUNC(keypadListKeys)(uint16_t mask, uint8_t *list)
+{
+  uint8_t count = 0;
+  while (mask)
+  {
+    list[count++] = (uint8_t)__builtin_ctz(mask);
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+uint16_t HOT_PATH_FUNC(keypadGhostMask)(uint16_t raw)
+{
+  uint16_t ghosted = 0;
+
+  // Two rows sharing two or more columns form at least one rectangle whose
+  // fourth corner may be phantom; all keys on those columns are suspect.
+  for (uint8_t a = 0; a < KEYPAD_MATRIX_ROWS - 1; a++)
+  {
+    uint16_t row_a = (raw >> (a * KEYPAD_MATRIX_COLS)) & KEYPAD_ROW_BITS;
+    if (row_a & (row_a - 1))
+    {
+      for (uint8_t b = a + 1; b < KEYPAD_MATRIX_ROWS; b++)
+      {
+        uint16_t shared = row_a & (raw >> (b * KEYPAD_MATRIX_COLS)) & KEYPAD_ROW_BITS;
+        if (shared & (shared - 1))
+          ghosted |= (uint16_t)((shared << (a * KEYPAD_MATRIX_COLS)) |
+                                (shared << (b * KEYPAD_MATRIX_COLS)));
+      }
+    }
+  }
+  return ghosted;
+}
+
+bool HOT_PATH_FUNC(keypadEventsUpdate)(uint16_t *keys, uint16_t raw, KeypadEvents *events)
+{
+  uint16_t ghosted = keypadGhostMask(raw);
+  uint16_t accepted = (uint16_t)((raw & ~ghosted) | (*keys & ghosted));
+  uint16_t changed = accepted ^ *keys;
+
+  events->keys = accepted;
+  events->pressed = changed & accepted;
+  events->released = changed & *keys;
+  events->ghosted = ghosted;
+  events->press_count = keypadListKeys(events->pressed, events->press_list);
+  events->release_count = keypadListKeys(events->released, events->release_list);
+
+  *keys = accepted;
+  return changed != 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file keypad_events.h
+ * @brief N-key rollover: turns raw matrix bitmaps into press/release events.
+ *
+ * Key bitmaps use bit (row * KEYPAD_MATRIX_COLS + col) per key. Every scan is
+ * diffed against the previous accepted state, so any number of simultaneous
+ * presses and releases are reported in one pass.
+ *
+ * The matrix has no diodes, so three keys on the corners of a rectangle make
+ * the fourth corner read as pressed too ("ghosting"). Keys involved in such an
+ * ambiguous rectangle keep their previous state until it resolves.
+ */
+#ifndef KEYPAD_EVENTS_H
+#define KEYPAD_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "keypad_pins.h"
+
+#define KEYPAD_MATRIX_KEYS (KEYPAD_MATRIX_ROWS * KEYPAD_MATRIX_COLS)
+
+/**
+ * @brief Key index of a matrix position.
+ */
+#define KEYPAD_KEY(row, col) ((row) * KEYPAD_MATRIX_COLS + (col))
+
+/**
+ * @brief Result of one scan.
+ */
+typedef struct
+{
+  uint16_t keys;                                //!< Accepted pressed keys after this scan
+  uint16_t pressed;                             //!< Keys that went down
+  uint16_t released;                            //!< Keys that went up
+  uint16_t ghosted;                             //!< Ambiguous keys held at their previous state
+  uint8_t press_count;                          //!< Entries in press_list
+  uint8_t release_count;                        //!< Entries in release_list
+  uint8_t press_list[KEYPAD_MATRIX_KEYS];       //!< Pressed key indices, ascending
+  uint8_t release_list[KEYPAD_MATRIX_KEYS];     //!< Released key indices, ascending
+} KeypadEvents;
+
+/**
+ * @brief Finds keys that cannot be trusted because of matrix ghosting.
+ *
+ * Three real presses make the fourth corner of their rectangle read as
+ * pressed, so a rectangle is ambiguous exactly when all four corners are set.
+ * @param raw Raw key bitmap
+ * @return Bitmap of every key on a rectangle with all four corners set
+ */
+uint16_t keypadGhostMask(uint16_t raw);
+
+/**
+ * @brief Diffs a raw scan against the previous state and lists the events.
+ * @param keys Accepted key state, updated in place (start from 0)
+ * @param raw Raw key bitmap of this scan
+ * @param events Receives the events of this scan
+ * @return true if at least one key was pressed or released
+ */
+bool keypadEventsUpdate(uint16_t *keys, uint16_t raw, KeypadEvents *events);
+
+#endif // KEYPAD_EVENTS_H
@@ -0,0 +1,105 @@
+/**
+ * @file keypad_irq.c
+ * @brief Edge-interrupt wake-up for the matrix keyboard.
+ */
+#include "keypad_irq.h"
+#include "hot_path.h"
+#include "keypad_pins.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if KEYPAD_ACTIVE_LOW
+#define KEYPAD_IRQ_EDGE GPIO_IRQ_EDGE_FALL
+#else
+#define KEYPAD_IRQ_EDGE GPIO_IRQ_EDGE_RISE
+#endif
+
+static volatile bool keypad_irq_pending = false;
+static volatile bool keypad_irq_wake = false;
+static volatile uint32_t keypad_irq_edge_us = 0;
+
+/**
+ * @brief GPIO callback: latches the press and masks further column edges.
+ */
+static void HOT_PATH_FUNC(keypadIrqCallback)(uint gpio, uint32_t events)
+{
+  (void)events;
+  if (gpio < KEYPAD_COL_BASE_PIN || gpio >= KEYPAD_COL_BASE_PIN + KEYPAD_MATRIX_COLS)
+    return;
+
+  keypad_irq_edge_us = time_us_32();
+
+  // Contact bounce would otherwise fire this again for every edge.
+  for (uint c = 0; c < KEYPAD_MATRIX_COLS; c++)
+    gpio_set_irq_enabled(KEYPAD_COL_BASE_PIN + c, KEYPAD_IRQ_EDGE, false);
+  keypad_irq_pending = true;
+}
+
+void initKeypadIrq(void)
+{
+  gpio_set_irq_enabled_with_callback(KEYPAD_COL_BASE_PIN, KEYPAD_IRQ_EDGE, false,
+                                     &keypadIrqCallback);
+}
+
+void keypadIrqArm(void)
+{
+  for (uint r = 0; r < KEYPAD_MATRIX_ROWS; r++)
+  {
+    gpio_set_dir(KEYPAD_ROW_BASE_PIN + r, GPIO_OUT);
+    gpio_put(KEYPAD_ROW_BASE_PIN + r, !KEYPAD_ACTIVE_LOW);
+  }
+  sleep_us(2); // Let the column lines settle before sampling them
+
+  keypad_irq_pending = false;
+  for (uint c = 0; c < KEYPAD_MATRIX_COLS; c++)
+  {
+    uint pin = KEYPAD_COL_BASE_PIN + c;
+    gpio_acknowledge_irq(pin, KEYPAD_IRQ_EDGE);
+    gpio_set_irq_enabled(pin, KEYPAD_IRQ_EDGE, true);
+
+    // A key still (or already) held produces no edge, so check the level too.
+    if (gpio_get(pin) == (KEYPAD_ACTIVE_LOW != 0))
+      continue;
+    keypadIrqCallback(pin, KEYPAD_IRQ_EDGE);
+    break;
+  }
+}
+
+void keypadIrqDisarm(void)
+{
+  for (uint c = 0; c < KEYPAD_MATRIX_COLS; c++)
+    gpio_set_irq_enabled(KEYPAD_COL_BASE_PIN + c, KEYPAD_IRQ_EDGE, false);
+}
+
+bool keypadIrqPending(void)
+{
+  return keypad_irq_pending;
+}
+
+void keypadIrqWait(void)
+{
+  while (true)
+  {
+    // Check and sleep with interrupts masked: a pending IRQ still ends WFI,
+    // so an edge that lands between the check and the WFI is not missed.
+    uint32_t status = save_and_disable_interrupts();
+    if (keypad_irq_pending || keypad_irq_wake)
+    {
+      keypad_irq_wake = false;
+      restore_interrupts(status);
+      return;
+    }
+    __wfi();
+    restore_interrupts(status);
+  }
+}
+
+uint32_t keypadIrqEdgeTime(void)
+{
+  return keypad_irq_edge_us;
+}
+
+void keypadIrqWake(void)
+{
+  keypad_irq_wake = true;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file keypad_irq.h
+ * @brief Edge-interrupt wake-up for the matrix keyboard.
+ *
+ * While no key is held, all rows are driven active and every column is armed
+ * for an edge interrupt, so a press is noticed immediately and the core can
+ * sleep in between. The pressed keys are then resolved by a regular scan.
+ */
+#ifndef KEYPAD_IRQ_H
+#define KEYPAD_IRQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Installs the column GPIO interrupt handler.
+ *
+ * Call once after initKeypadMatrix().
+ */
+void initKeypadIrq(void);
+
+/**
+ * @brief Drives all rows active and enables the column edge interrupts.
+ *
+ * Call when no key is held anymore; pending state is cleared.
+ */
+void keypadIrqArm(void);
+
+/**
+ * @brief Disables the column interrupts so the matrix can be scanned.
+ */
+void keypadIrqDisarm(void);
+
+/**
+ * @brief Checks whether a column edge was seen since the last keypadIrqArm().
+ * @return true if a key press woke the scanner
+ */
+bool keypadIrqPending(void);
+
+/**
+ * @brief time_us_32() of the column edge that set the pending flag.
+ */
+uint32_t keypadIrqEdgeTime(void);
+
+/**
+ * @brief Sleeps the core (WFI) until a column edge is seen.
+ *
+ * Other interrupts (timers, USB) also wake the core briefly; this only
+ * returns once a key press is pending or keypadIrqWake() was called.
+ */
+void keypadIrqWait(void);
+
+/**
+ * @brief Makes keypadIrqWait() return without a key press.
+ *
+ * Safe to call from IRQ context, e.g. when console input arrives.
+ */
+void keypadIrqWake(void);
+
+#endif // KEYPAD_IRQ_H
@@ -0,0 +1,47 @@
+/**
+ * @file keypad_matrix.c
+ * @brief Software full-matrix scan returning every pressed key at once.
+ */
+#include "keypad_matrix.h"
+#include "hot_path.h"
+#include "keypad_pins.h"
+#include "pico/stdlib.h"
+
+#define KEYPAD_ROW_IDLE (KEYPAD_ACTIVE_LOW != 0)
+
+void initKeypadMatrix(void)
+{
+  gpio_init_mask(KEYPAD_ROW_MASK | KEYPAD_COL_MASK);
+  gpio_set_dir_out_masked(KEYPAD_ROW_MASK);
+  gpio_put_masked(KEYPAD_ROW_MASK, KEYPAD_ROW_IDLE ? KEYPAD_ROW_MASK : 0);
+
+  for (uint c = 0; c < KEYPAD_MATRIX_COLS; c++)
+  {
+#if KEYPAD_ACTIVE_LOW
+    gpio_pull_up(KEYPAD_COL_BASE_PIN + c);
+#else
+    gpio_pull_down(KEYPAD_COL_BASE_PIN + c);
+#endif
+  }
+}
+
+uint16_t HOT_PATH_FUNC(keypadMatrixRead)(void)
+{
+  uint16_t keys = 0;
+
+  for (uint r = 0; r < KEYPAD_MATRIX_ROWS; r++)
+  {
+    uint32_t row_bit = 1u << (KEYPAD_ROW_BASE_PIN + r);
+    gpio_put_masked(KEYPAD_ROW_MASK, KEYPAD_ROW_IDLE ? KEYPAD_ROW_MASK & ~row_bit : row_bit);
+    busy_wait_us_32(2); // Let the column lines settle
+
+    uint32_t cols = gpio_get_all();
+#if KEYPAD_ACTIVE_LOW
+    cols = ~cols;
+#endif
+    keys |= (uint16_t)(((cols & KEYPAD_COL_MASK) >> KEYPAD_COL_BASE_PIN) << (r * KEYPAD_MATRIX_COLS));
+  }
+
+  gpio_put_masked(KEYPAD_ROW_MASK, KEYPAD_ROW_IDLE ? KEYPAD_ROW_MASK : 0);
+  return keys;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file keypad_matrix.h
+ * @brief Software full-matrix scan returning every pressed key at once.
+ *
+ * keypadScan() stops at the first pressed key; this scan samples all four
+ * rows and returns the complete bitmap, for use with keypad_events.h.
+ */
+#ifndef KEYPAD_MATRIX_H
+#define KEYPAD_MATRIX_H
+
+#include <stdint.h>
+
+/**
+ * @brief Configures the row and column GPIOs from keypad_pins.h.
+ */
+void initKeypadMatrix(void);
+
+/**
+ * @brief Scans all rows and returns the raw key bitmap.
+ *
+ * Rows are left inactive afterwards.
+ * @return Bit (row * 4 + col) is set for every key that reads pressed
+ */
+uint16_t keypadMatrixRead(void);
+
+#endif // KEYPAD_MATRIX_H
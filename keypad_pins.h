@@ -0,0 +1,41 @@
+/**
+ * @file keypad_pins.h
+ * @brief GPIO wiring of the 4x4 matrix keyboard.
+ *
+ * Shared by the matrix, edge-interrupt and PIO scanners. Rows and columns
+ * each occupy consecutive GPIOs so that the matrix can also be driven by PIO;
+ * override the base pins with compile definitions if your board is wired
+ * differently.
+ */
+#ifndef KEYPAD_PINS_H
+#define KEYPAD_PINS_H
+
+#define KEYPAD_MATRIX_ROWS 4
+#define KEYPAD_MATRIX_COLS 4
+
+/**
+ * @brief First GPIO of the row lines (rows are strobed).
+ */
+#ifndef KEYPAD_ROW_BASE_PIN
+#define KEYPAD_ROW_BASE_PIN 16
+#endif
+
+/**
+ * @brief First GPIO of the column lines (columns are sampled).
+ */
+#ifndef KEYPAD_COL_BASE_PIN
+#define KEYPAD_COL_BASE_PIN 8
+#endif
+
+/**
+ * @brief 1 if a pressed key pulls its column low (rows driven low, columns
+ * pulled up), 0 for the opposite polarity.
+ */
+#ifndef KEYPAD_ACTIVE_LOW
+#define KEYPAD_ACTIVE_LOW 1
+#endif
+
+#define KEYPAD_ROW_MASK (((1u << KEYPAD_MATRIX_ROWS) - 1) << KEYPAD_ROW_BASE_PIN)
+#define KEYPAD_COL_MASK (((1u << KEYPAD_MATRIX_COLS) - 1) << KEYPAD_COL_BASE_PIN)
+
+#endif // KEYPAD_PINS_H
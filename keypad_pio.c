@@ -0,0 +1,75 @@
+/**
+ * @file keypad_pio.c
+ * @brief Zero-CPU matrix keyboard scanning with PIO and DMA.
+ */
+#include "keypad_pio.h"
+#include "hot_path.h"
+#include "keypad_pins.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "keypad_scan.pio.h"
+
+// Raw ISR words as pushed by the state machine; all keys released at boot.
+#define KEYPAD_PIO_IDLE_RAW 0xFFFF0000u
+
+static volatile uint32_t keypad_pio_raw = KEYPAD_PIO_IDLE_RAW;
+
+// The control channel rewrites this count into the data channel, restarting
+// it forever without CPU involvement.
+static const uint32_t keypad_pio_reload = 0xFFFFFFFFu;
+
+void initKeypadPio(uint scan_hz)
+{
+  PIO pio = pio0;
+  uint sm = (uint)pio_claim_unused_sm(pio, true);
+  uint offset = pio_add_program(pio, &keypad_scan_program);
+
+  // Columns idle at the inactive level.
+  for (uint i = 0; i < KEYPAD_MATRIX_COLS; i++)
+  {
+#if KEYPAD_ACTIVE_LOW
+    gpio_pull_up(KEYPAD_COL_BASE_PIN + i);
+#else
+    gpio_pull_down(KEYPAD_COL_BASE_PIN + i);
+#endif
+  }
+
+  float clkdiv = (float)clock_get_hz(clk_sys) / ((float)scan_hz * KEYPAD_SCAN_CYCLES_PER_PASS);
+  keypad_scan_program_init(pio, sm, offset, KEYPAD_ROW_BASE_PIN, KEYPAD_COL_BASE_PIN, clkdiv);
+
+#if !KEYPAD_ACTIVE_LOW
+  // Active-high boards invert the pads so the same active-low program can be
+  // used. pio_gpio_init() rewrites the IO control registers and clears any
+  // override, so this has to come after the program init.
+  for (uint i = 0; i < KEYPAD_MATRIX_COLS; i++)
+    gpio_set_inover(KEYPAD_COL_BASE_PIN + i, GPIO_OVERRIDE_INVERT);
+  for (uint i = 0; i < KEYPAD_MATRIX_ROWS; i++)
+    gpio_set_outover(KEYPAD_ROW_BASE_PIN + i, GPIO_OVERRIDE_INVERT);
+#endif
+
+  uint data_chan = (uint)dma_claim_unused_channel(true);
+  uint ctrl_chan = (uint)dma_claim_unused_channel(true);
+
+  dma_channel_config ctrl = dma_channel_get_default_config(ctrl_chan);
+  channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+  channel_config_set_read_increment(&ctrl, false);
+  channel_config_set_write_increment(&ctrl, false);
+  dma_channel_configure(ctrl_chan, &ctrl, &dma_hw->ch[data_chan].al1_transfer_count_trig,
+                        &keypad_pio_reload, 1, false);
+
+  dma_channel_config data = dma_channel_get_default_config(data_chan);
+  channel_config_set_transfer_data_size(&data, DMA_SIZE_32);
+  channel_config_set_read_increment(&data, false);
+  channel_config_set_write_increment(&data, false);
+  channel_config_set_dreq(&data, pio_get_dreq(pio, sm, false));
+  channel_config_set_chain_to(&data, ctrl_chan);
+  dma_channel_configure(data_chan, &data, &keypad_pio_raw, &pio->rxf[sm],
+                        keypad_pio_reload, true);
+}
+
+uint16_t HOT_PATH_FUNC(keypadPioKeys)(void)
+{
+  return (uint16_t)~(keypad_pio_raw >> 16);
+}
@@ -0,0 +1,36 @@
+/**
+ * @file keypad_pio.h
+ * @brief Zero-CPU matrix keyboard scanning with PIO and DMA.
+ *
+ * A PIO state machine strobes the rows and samples the columns at a fixed
+ * rate, and a DMA channel copies every pass into a RAM word. Reading the key
+ * state is a single load; the CPU never touches the matrix pins.
+ */
+#ifndef KEYPAD_PIO_H
+#define KEYPAD_PIO_H
+
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief Default full-matrix scan rate (passes per second).
+ */
+#ifndef KEYPAD_PIO_SCAN_HZ
+#define KEYPAD_PIO_SCAN_HZ 1000
+#endif
+
+/**
+ * @brief Loads the scanner program and starts the PIO/DMA scan.
+ *
+ * Takes over the keypad pins; keypadMatrixRead() must not be used afterwards.
+ * @param scan_hz Full-matrix passes per second
+ */
+void initKeypadPio(uint scan_hz);
+
+/**
+ * @brief Latest key bitmap produced by the scanner.
+ * @return Bit (row * 4 + col) is set while that key is pressed
+ */
+uint16_t keypadPioKeys(void);
+
+#endif // KEYPAD_PIO_H
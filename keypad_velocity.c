@@ -0,0 +1,44 @@
+/**
+ * @file keypad_velocity.c
+ * @brief Key velocity from the time a press takes to settle.
+ */
+#include "keypad_velocity.h"
+#include "hot_path.h"
+
+void keypadVelocityInit(KeypadVelocity *velocity)
+{
+  velocity->touched = 0;
+}
+
+void HOT_PATH_FUNC(keypadVelocityScan)(KeypadVelocity *velocity, uint16_t raw, uint16_t keys,
+                                       uint16_t counting, uint32_t scan_us)
+{
+  // Only a released key reading down starts a press; later bounces don't
+  // move its first contact.
+  uint16_t first = raw & (uint16_t)~keys & (uint16_t)~velocity->touched;
+  while (first)
+  {
+    velocity->first_us[__builtin_ctz(first)] = scan_us;
+    first &= first - 1;
+  }
+
+  // A touch the debouncer rejected (key up again and no longer counting) is
+  // forgotten, so it can't slow down the next press.
+  velocity->touched = (velocity->touched | (raw & (uint16_t)~keys)) & (raw | counting);
+}
+
+uint8_t HOT_PATH_FUNC(keypadVelocityPress)(KeypadVelocity *velocity, uint8_t key, uint32_t now_us)
+{
+  uint16_t bit = (uint16_t)(1u << key);
+  if (!(velocity->touched & bit))
+    return KEYPAD_VELOCITY_DEFAULT;
+  velocity->touched &= (uint16_t)~bit;
+
+  uint32_t settle_us = now_us - velocity->first_us[key];
+  if (settle_us <= KEYPAD_VELOCITY_FAST_US)
+    return 127;
+  if (settle_us >= KEYPAD_VELOCITY_SLOW_US)
+    return 1;
+  return (uint8_t)(127 - ((settle_us - KEYPAD_VELOCITY_FAST_US) * 126) /
+                             (KEYPAD_VELOCITY_SLOW_US - KEYPAD_VELOCITY_FAST_US));
+}
@@ -0,0 +1,76 @@
+/**
+ * @file keypad_velocity.h
+ * @brief Key velocity from the time a press takes to settle.
+ *
+ * A key struck hard closes cleanly, one struck softly makes tentative contact
+ * and bounces for longer before the debouncer accepts it. Each key's first
+ * contact is timestamped when its raw reading first goes down; when the press
+ * is accepted, the time since then maps linearly onto a MIDI velocity, from
+ * 127 at KEYPAD_VELOCITY_FAST_US or less to 1 at KEYPAD_VELOCITY_SLOW_US or
+ * more. Per scan this costs a few bitwise operations plus one timestamp store
+ * per key that starts a press.
+ */
+#ifndef KEYPAD_VELOCITY_H
+#define KEYPAD_VELOCITY_H
+
+#include <stdint.h>
+#include "keypad_events.h"
+
+/**
+ * @brief First contact to accepted press at or below which velocity is 127.
+ */
+#ifndef KEYPAD_VELOCITY_FAST_US
+#define KEYPAD_VELOCITY_FAST_US 1000
+#endif
+
+/**
+ * @brief First contact to accepted press at or above which velocity is 1.
+ */
+#ifndef KEYPAD_VELOCITY_SLOW_US
+#define KEYPAD_VELOCITY_SLOW_US 12000
+#endif
+
+#if KEYPAD_VELOCITY_SLOW_US <= KEYPAD_VELOCITY_FAST_US
+#error "KEYPAD_VELOCITY_SLOW_US must be greater than KEYPAD_VELOCITY_FAST_US"
+#endif
+
+/**
+ * @brief Velocity of every key that is not captured (or not measurable).
+ */
+#define KEYPAD_VELOCITY_DEFAULT 127
+
+/**
+ * @brief First-contact timestamps of the keys being pressed.
+ */
+typedef struct
+{
+  uint16_t touched;                         //!< Keys with a first contact recorded
+  uint32_t first_us[KEYPAD_MATRIX_KEYS];    //!< Time of first contact per key
+} KeypadVelocity;
+
+/**
+ * @brief Forgets every first contact.
+ */
+void keypadVelocityInit(KeypadVelocity *velocity);
+
+/**
+ * @brief Records first contacts from one raw scan.
+ * @param velocity Velocity state
+ * @param raw Raw key bitmap of the scan
+ * @param keys Accepted (debounced) key bitmap before the scan
+ * @param counting Keys still changing (debounceCounting()) after the scan
+ * @param scan_us time_us_32() of the scan (or of the column edge that woke it)
+ */
+void keypadVelocityScan(KeypadVelocity *velocity, uint16_t raw, uint16_t keys, uint16_t counting,
+                        uint32_t scan_us);
+
+/**
+ * @brief Velocity of a press that has just been accepted.
+ * @param velocity Velocity state
+ * @param key Key index
+ * @param now_us time_us_32() of the scan that accepted the press
+ * @return MIDI velocity 1..127
+ */
+uint8_t keypadVelocityPress(KeypadVelocity *velocity, uint8_t key, uint32_t now_us);
+
+#endif // KEYPAD_VELOCITY_H
@@ -0,0 +1,95 @@
+/**
+ * @file latency.c
+ * @brief Key-to-sound latency statistics.
+ */
+#include "latency.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Statistics of one stage.
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t buckets[LATENCY_BUCKETS];
+  volatile bool reset_pending;
+} LatencyStats;
+
+static LatencyStats latency_stats[LATENCY_STAGE_COUNT];
+
+static const char *const latency_stage_names[LATENCY_STAGE_COUNT] = {
+    "detect->enqueue",
+    "enqueue->audio",
+    "key->sound",
+    "wake->sound",
+};
+
+void latencyRecord(LatencyStage stage, uint32_t us)
+{
+  LatencyStats *stats = &latency_stats[stage];
+
+  if (stats->reset_pending)
+  {
+    memset(stats->buckets, 0, sizeof(stats->buckets));
+    stats->count = 0;
+    stats->sum_us = 0;
+    stats->max_us = 0;
+    stats->reset_pending = false;
+  }
+
+  if (stats->count == 0 || us < stats->min_us)
+    stats->min_us = us;
+  if (us > stats->max_us)
+    stats->max_us = us;
+  stats->sum_us += us;
+  stats->count++;
+
+  uint32_t bucket = us / LATENCY_BUCKET_US;
+  stats->buckets[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+}
+
+void latencyReset(void)
+{
+  for (int s = 0; s < LATENCY_STAGE_COUNT; s++)
+    latency_stats[s].reset_pending = true;
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile.
+ */
+static uint32_t latencyPercentile(const LatencyStats *stats, uint32_t percent)
+{
+  uint32_t target = (uint32_t)(((uint64_t)stats->count * percent + 99) / 100);
+  uint32_t seen = 0;
+
+  for (uint32_t b = 0; b < LATENCY_BUCKETS; b++)
+  {
+    seen += stats->buckets[b];
+    if (seen >= target)
+      return b < LATENCY_BUCKETS - 1 ? (b + 1) * LATENCY_BUCKET_US : stats->max_us;
+  }
+  return stats->max_us;
+}
+
+void latencyDump(void)
+{
+  printf("latency (us)         count      min      avg      p99      max\n");
+  for (int s = 0; s < LATENCY_STAGE_COUNT; s++)
+  {
+    const LatencyStats *stats = &latency_stats[s];
+    if (stats->count == 0 || stats->reset_pending)
+    {
+      printf("%-16s %9d        -        -        -        -\n", latency_stage_names[s], 0);
+      continue;
+    }
+    printf("%-16s %9lu %8lu %8lu %8lu %8lu\n", latency_stage_names[s],
+           (unsigned long)stats->count, (unsigned long)stats->min_us,
+           (unsigned long)(stats->sum_us / stats->count),
+           (unsigned long)latencyPercentile(stats, 99), (unsigned long)stats->max_us);
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file latency.h
+ * @brief Key-to-sound latency statistics.
+ *
+ * Each stage of the note path keeps min/avg/max and a fixed-width histogram
+ * (for percentiles) in RAM. A stage must only be recorded from one core;
+ * resets are deferred to that core's next record so no lock is needed.
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+/**
+ * @brief Histogram bucket width in us.
+ */
+#ifndef LATENCY_BUCKET_US
+#define LATENCY_BUCKET_US 250
+#endif
+
+/**
+ * @brief Number of histogram buckets; the last one also counts overflows.
+ */
+#ifndef LATENCY_BUCKETS
+#define LATENCY_BUCKETS 64
+#endif
+
+/**
+ * @brief Measured stages of the note path.
+ */
+typedef enum
+{
+  LATENCY_DETECT_TO_ENQUEUE, //!< Column edge (or scan) to event queued, core 0
+  LATENCY_ENQUEUE_TO_AUDIO,  //!< Event queued to its first sample leaving the PWM, core 1
+  LATENCY_KEY_TO_SOUND,      //!< Column edge (or scan) to first sample, core 1
+  LATENCY_WAKE_TO_SOUND,     //!< Column edge that ended low-power idle to first sample
+  LATENCY_STAGE_COUNT
+} LatencyStage;
+
+/**
+ * @brief Adds one measurement to a stage.
+ * @param stage Stage to update
+ * @param us Measured duration in us
+ */
+void latencyRecord(LatencyStage stage, uint32_t us);
+
+/**
+ * @brief Clears every stage (applied on each stage's next record).
+ */
+void latencyReset(void);
+
+/**
+ * @brief Prints count/min/avg/p99/max of every stage to stdio.
+ */
+void latencyDump(void);
+
+#endif // LATENCY_H
@@ -0,0 +1,67 @@
+/**
+ * @file led.c
+ * @brief Non-blocking LED feedback.
+ */
+#include "led.h"
+#include "scheduler.h"
+#include "pico/stdlib.h"
+
+static volatile SchedulerId led_event = 0;
+static volatile uint32_t led_toggles_left = 0;
+static uint32_t led_delay_us;
+
+/**
+ * @brief Scheduler callback: toggles the LED until the pattern is done.
+ */
+static uint32_t ledToggleCallback(void *user_data)
+{
+  (void)user_data;
+
+  if (led_toggles_left == 0)
+  {
+    led_event = 0;
+    return 0;
+  }
+
+  led_toggles_left--;
+  gpio_put(LED_RED_PIN, led_toggles_left & 1);
+
+  if (led_toggles_left == 0)
+  {
+    led_event = 0;
+    return 0;
+  }
+  // Relative to the previous deadline, so the pattern keeps its pace.
+  return led_delay_us;
+}
+
+void initLed(void)
+{
+  gpio_init(LED_RED_PIN);
+  gpio_set_dir(LED_RED_PIN, GPIO_OUT);
+  gpio_put(LED_RED_PIN, 0);
+}
+
+void ledBlink(uint32_t times, uint32_t delay_ms)
+{
+  schedulerCancel(led_event);
+  led_event = 0;
+
+  if (times == 0)
+  {
+    led_toggles_left = 0;
+    gpio_put(LED_RED_PIN, 0);
+    return;
+  }
+
+  // The LED goes on now; each remaining toggle alternates off/on, ending off.
+  led_delay_us = delay_ms * 1000;
+  led_toggles_left = times * 2 - 1;
+  gpio_put(LED_RED_PIN, 1);
+  led_event = schedulerIn(led_delay_us, ledToggleCallback, NULL);
+}
+
+bool ledBusy(void)
+{
+  return led_toggles_left != 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file led.h
+ * @brief Non-blocking LED feedback.
+ *
+ * Blink patterns run as a small state machine on the tick scheduler
+ * (scheduler.h), so signalling a key press never delays the scan or the
+ * note it belongs to.
+ */
+#ifndef LED_H
+#define LED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief GPIO of the red LED.
+ */
+#ifndef LED_RED_PIN
+#define LED_RED_PIN 13
+#endif
+
+/**
+ * @brief Configures the LED GPIO (off).
+ */
+void initLed(void);
+
+/**
+ * @brief Blinks the red LED in the background and returns immediately.
+ *
+ * A blink pattern still running is restarted with the new one.
+ * @param times How many times to blink
+ * @param delay_ms Time on and time off per blink, in ms
+ */
+void ledBlink(uint32_t times, uint32_t delay_ms);
+
+/**
+ * @brief Checks whether a blink pattern is still running.
+ */
+bool ledBusy(void);
+
+#endif // LED_H
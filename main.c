@@ -19,72 +19,774 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "buzzer.h"
-#include "keypad.h"
+#include "tone.h"
+#include "audio.h"
+#include "led.h"
+#include "arpeggiator.h"
+#include "console.h"
+#include "debounce.h"
+#include "keymap.h"
+#include "latency.h"
+#include "metronome.h"
+#include "notes.h"
+#include "power.h"
+#include "recorder.h"
+#include "sampler.h"
+#include "scheduler.h"
+#include "synth.h"
+#include "telemetry.h"
+#include "usb_device.h"
+#include "usb_midi.h"
+#include "welcome.h"
+#include "keypad_events.h"
+#include "keypad_irq.h"
+#include "keypad_matrix.h"
+#include "keypad_pio.h"
+#include "keypad_velocity.h"
 
-#define LED_RED_PIN 13
+/**
+ * @brief Keypad scan period (us); keys settle after DEBOUNCE_PRESS_SCANS or
+ * DEBOUNCE_RELEASE_SCANS of these.
+ */
+#ifndef KEYPAD_SCAN_PERIOD_US
+#define KEYPAD_SCAN_PERIOD_US 1000
+#endif
+
+/**
+ * @brief 1 to mix up to SYNTH_MAX_VOICES held keys, 0 for the monophonic
+ * tone engine.
+ */
+#ifndef PIANO_POLYPHONIC
+#define PIANO_POLYPHONIC 1
+#endif
+
+/**
+ * @brief 1 to derive note velocity from how long each press takes to settle
+ * (keypad_velocity.h), 0 to play every note at full velocity.
+ */
+#ifndef PIANO_VELOCITY
+#define PIANO_VELOCITY 1
+#endif
+
+/**
+ * @brief 1 to send key events as USB-MIDI notes and play incoming ones,
+ * through a CDC + MIDI composite device that also carries the console.
+ */
+#ifndef PIANO_USB_MIDI
+#define PIANO_USB_MIDI 1
+#endif
+
+/**
+ * @brief 1 to record and loop what is played (console 'r', 'y', 's').
+ */
+#ifndef PIANO_RECORDER
+#define PIANO_RECORDER 1
+#endif
+
+/**
+ * @brief Note id of notes not played on the keypad (USB-MIDI input,
+ * recorder playback), kept apart from key indices.
+ */
+#define EXTERNAL_NOTE_ID(note) (0x80 | (note))
+
+/**
+ * @brief 1 for metronome clicks (console 'm', tempo '+'/'-'); needs
+ * PIANO_POLYPHONIC.
+ */
+#ifndef PIANO_METRONOME
+#define PIANO_METRONOME 1
+#endif
+
+/**
+ * @brief 1 for the arpeggiator over the held keys (console 'a'); needs
+ * PIANO_POLYPHONIC.
+ */
+#ifndef PIANO_ARPEGGIATOR
+#define PIANO_ARPEGGIATOR 1
+#endif
+
+/**
+ * @brief Note ids of metronome clicks and arpeggiated notes, apart from key
+ * indices and external notes.
+ */
+#define METRONOME_NOTE_ID 0x40
+#define ARP_NOTE_ID 0x41
+#define WELCOME_NOTE_ID 0x42
+
+/**
+ * @brief 1 to scan the keypad right after the peripherals are set up: the
+ * welcome jingle plays in the background (welcome.h) and USB is brought up
+ * once the keypad is live. 0 keeps the blocking playWelcomeTones().
+ */
+#ifndef PIANO_FAST_BOOT
+#define PIANO_FAST_BOOT 1
+#endif
+
+/**
+ * @brief 1 to sleep until a column edge instead of polling while idle.
+ */
+#ifndef KEYPAD_USE_IRQ
+#define KEYPAD_USE_IRQ 1
+#endif
+
+/**
+ * @brief 1 to clock down after POWER_IDLE_TIMEOUT_MS without key activity
+ * (needs KEYPAD_USE_IRQ for the wake-up).
+ */
+#ifndef PIANO_LOW_POWER
+#define PIANO_LOW_POWER 1
+#endif
+
+/**
+ * @brief 1 to scan the matrix with PIO/DMA instead of keypadMatrixRead().
+ */
+#ifndef KEYPAD_USE_PIO
+#define KEYPAD_USE_PIO 0
+#endif
+
+/**
+ * @brief Note each key started on its last press, so a release matches its
+ * press even if the layout changed in between.
+ */
+uint8_t key_notes[KEYPAD_MATRIX_KEYS];
+
+/**
+ * @brief Looks up the note of a key being pressed in the active layout.
+ * @param key Key index (row * 4 + col)
+ * @return MIDI note number
+ */
+uint8_t pressKeyNote(uint8_t key)
+{
+  key_notes[key] = keymapNote(key);
+  return key_notes[key];
+}
+
+/**
+ * @brief Note a key is playing.
+ * @param key Key index (row * 4 + col)
+ * @return MIDI note number chosen when the key was pressed
+ */
+uint8_t keyNote(uint8_t key)
+{
+  return key_notes[key];
+}
+
+/**
+ * @brief Console command: switches to the next tuning.
+ */
+void cycleTuning()
+{
+  noteSetTuning((NoteTuning)((noteTuning() + 1) % TUNING_COUNT));
+  printf("tuning %d\n", (int)noteTuning());
+}
+
+/**
+ * @brief Console command: switches to the next key layout.
+ */
+void cycleKeymap()
+{
+  keymapSelect((KeymapLayout)((keymapLayout() + 1) % KEYMAP_COUNT));
+  printf("keymap %s\n", keymapName(keymapLayout()));
+}
+
+/**
+ * @brief Console command: switches new notes to the next waveform.
+ */
+void cycleWaveform()
+{
+  synthSetWaveform((SynthWaveform)((synthWaveform() + 1) % SYNTH_WAVE_COUNT));
+  printf("waveform %d\n", (int)synthWaveform());
+}
+
+#if PIANO_POLYPHONIC && PIANO_SAMPLER
+/**
+ * @brief Console command: switches new notes between the synthesizer and
+ * the sample voices.
+ */
+void toggleSampler()
+{
+  audioUseSampler(!audioUsingSampler());
+  if (audioUsingSampler())
+    printf("instrument sample (%lu bytes, %lu stalls)\n", (unsigned long)samplerDataBytes(),
+           (unsigned long)samplerStalls());
+  else
+    printf("instrument synth\n");
+}
+#endif
+
+#if !PIANO_POLYPHONIC
+bool tone_wake_pending = false;
+
+/**
+ * @brief Power wake hook: measures the next tone as the wake-up note.
+ */
+void toneWake()
+{
+  tone_wake_pending = true;
+}
+#endif
+
+#if PIANO_USB_MIDI || PIANO_RECORDER
+/**
+ * @brief Plays a note from USB-MIDI input or recorder playback on the
+ * synthesizer (IRQ context).
+ */
+void playExternalNote(uint8_t note, uint8_t velocity)
+{
+#if PIANO_POLYPHONIC
+  if (velocity > 0)
+    audioNoteOn(EXTERNAL_NOTE_ID(note), note, velocity, time_us_32());
+  else
+    audioNoteOff(EXTERNAL_NOTE_ID(note), time_us_32());
+#else
+  // The tone engine belongs to the keypad; other notes are ignored.
+  (void)note;
+  (void)velocity;
+#endif
+}
+#endif
+
+#if PIANO_USB_MIDI
+/**
+ * @brief USB-MIDI input arrived (USB task IRQ context): counts as activity, so
+ * the core stays at full clock, and wakes it if it had clocked down, so the
+ * notes are heard without a key press first.
+ */
+void usbMidiActivity()
+{
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+  powerActivity();
+  keypadIrqWake();
+#endif
+}
+#endif
+
+#if PIANO_METRONOME
+/**
+ * @brief Plays a metronome click on the synthesizer (scheduler IRQ context).
+ */
+void playMetronomeNote(uint8_t note, uint8_t velocity)
+{
+  if (velocity > 0)
+    audioNoteOn(METRONOME_NOTE_ID, note, velocity, time_us_32());
+  else
+    audioNoteOff(METRONOME_NOTE_ID, time_us_32());
+}
+
+/**
+ * @brief Console command: starts or stops the metronome.
+ */
+void toggleMetronome()
+{
+  if (metronomeRunning())
+  {
+    metronomeStop();
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+    powerActivity(); // The idle timeout counts from here, not from the last key
+#endif
+    printf("metronome off\n");
+  }
+  else
+  {
+    metronomeStart();
+    printf("metronome %lu bpm\n", (unsigned long)metronomeBpm());
+  }
+}
+#endif
+
+#if PIANO_ARPEGGIATOR
+/**
+ * @brief Plays an arpeggiated note on the synthesizer (scheduler IRQ context).
+ */
+void playArpNote(uint8_t note, uint8_t velocity)
+{
+  if (velocity > 0)
+    audioNoteOn(ARP_NOTE_ID, note, velocity, time_us_32());
+  else
+    audioNoteOff(ARP_NOTE_ID, time_us_32());
+}
+
+/**
+ * @brief Console command: switches the arpeggiator to the next note order.
+ */
+void cycleArp()
+{
+  arpSetMode((ArpMode)((arpMode() + 1) % ARP_MODE_COUNT));
+  printf("arpeggiator %s\n", arpModeName(arpMode()));
+}
+#endif
+
+#if PIANO_METRONOME || PIANO_ARPEGGIATOR
+/**
+ * @brief Console command: raises the tempo by 10 BPM.
+ */
+void tempoUp()
+{
+  metronomeSetBpm(metronomeBpm() + 10);
+  printf("tempo %lu bpm\n", (unsigned long)metronomeBpm());
+}
+
+/**
+ * @brief Console command: lowers the tempo by 10 BPM.
+ */
+void tempoDown()
+{
+  metronomeSetBpm(metronomeBpm() - 10);
+  printf("tempo %lu bpm\n", (unsigned long)metronomeBpm());
+}
+#endif
+
+#if PIANO_FAST_BOOT
+/**
+ * @brief Plays a note of the welcome jingle (scheduler IRQ context).
+ */
+void playWelcomeNote(uint8_t note, uint8_t velocity)
+{
+#if PIANO_POLYPHONIC
+  if (velocity > 0)
+    audioNoteOn(WELCOME_NOTE_ID, note, velocity, time_us_32());
+  else
+    audioNoteOff(WELCOME_NOTE_ID, time_us_32());
+#else
+  if (velocity > 0)
+    toneStartNote(note, 0);
+  else
+    toneStop();
+#endif
+}
+#endif
+
+/**
+ * @brief time_us_32() when the scan loop was entered, i.e. the time from
+ * reset until the keypad is live.
+ */
+uint32_t boot_ready_us = 0;
 
 /**
- * @brief Frequency map for each key in the 4x4 matrix (Hz).
+ * @brief Console command: prints the boot-to-first-scan time.
  */
-const int keypad_freq_map[4][4] = {
-    {262, 294, 330, 349},  // C4, D4, E4, F4
-    {392, 440, 494, 523},  // G4, A4, B4, C5
-    {587, 659, 698, 784},  // D5, E5, F5, G5
-    {880, 988, 1047, 1175} // A5, B5, C6, D6
-};
+void bootDump()
+{
+  printf("boot to first scan %lu us (%s)\n", (unsigned long)boot_ready_us,
+         PIANO_FAST_BOOT ? "fast boot" : "welcome tones first");
+}
+
+#if PIANO_RECORDER
+/**
+ * @brief Console command: starts or stops recording.
+ */
+void toggleRecording()
+{
+  if (recorderState() == RECORDER_RECORDING)
+  {
+    recorderStop();
+    printf("recorded %lu bytes\n", (unsigned long)recorderLength());
+  }
+  else if (recorderSaving())
+  {
+    printf("saving, try again\n");
+  }
+  else if (recorderStart())
+  {
+    printf("recording\n");
+  }
+}
 
 /**
- * @brief Pisca o LED vermelho conectado ao pino 13.
- * @param times Quantas vezes piscar
- * @param delay_ms Delay em ms entre liga/desliga
+ * @brief Console command: starts or stops looping the recorded take.
  */
-void blink_led_red(int times, int delay_ms)
+void togglePlayback()
 {
-  for (int i = 0; i < times; i++)
+  if (recorderState() == RECORDER_PLAYING)
   {
-    gpio_put(LED_RED_PIN, 1);
-    sleep_ms(delay_ms);
-    gpio_put(LED_RED_PIN, 0);
-    sleep_ms(delay_ms);
+    recorderStop();
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+    powerActivity(); // The idle timeout counts from here, not from the last key
+#endif
   }
+  else if (recorderSaving())
+    printf("saving, try again\n");
+  else if (!recorderPlay(true))
+    printf("nothing to play\n");
+}
+
+/**
+ * @brief Console command: saves the take to flash.
+ */
+void saveRecording()
+{
+  if (recorderSaving())
+    printf("saving, try again\n");
+  else if (!recorderSave())
+    printf("stop recording/playback first\n");
+}
+#endif
+
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+/**
+ * @brief Whether something is sounding without key activity (metronome clicks,
+ * recorder playback); it needs the audio output, which clocking down stops.
+ */
+bool playingUnattended()
+{
+#if PIANO_METRONOME
+  if (metronomeRunning())
+    return true;
+#endif
+#if PIANO_RECORDER && PIANO_POLYPHONIC
+  if (recorderState() == RECORDER_PLAYING)
+    return true;
+#endif
+  return false;
+}
+#endif
+
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+/**
+ * @brief Power sleep hook: stops the sound output and the USB frame tick, which
+ * would otherwise leave WFI every millisecond.
+ */
+void lowPowerSleep()
+{
+#if PIANO_POLYPHONIC
+  audioSuspend();
+#else
+  toneStop();
+#endif
+#if PIANO_USB_MIDI
+  usbDeviceSleep();
+#endif
+}
+
+/**
+ * @brief Power wake hook: undoes lowPowerSleep().
+ */
+void lowPowerWake()
+{
+#if PIANO_USB_MIDI
+  usbDeviceWake();
+#endif
+#if PIANO_POLYPHONIC
+  audioResume();
+#else
+  toneWake();
+#endif
+}
+#endif
+
+uint16_t keys = 0;
+KeypadEvents events;
+Debouncer debouncer;
+KeypadVelocity key_velocity;
+
+/**
+ * @brief Brings up the USB console, and the USB-MIDI device with it.
+ *
+ * Enumeration itself is driven by the host and completes in the background.
+ */
+void initUsb()
+{
+  stdio_init_all();
+#if PIANO_USB_MIDI
+  initUsbMidi(playExternalNote, usbMidiActivity);
+  initUsbDevice();
+#endif
+#if KEYPAD_USE_IRQ
+  // Only reaches the stdio drivers enabled so far.
+  consoleSetInputCallback(keypadIrqWake);
+#endif
 }
 
 /**
  * @brief Initializes the standard IO, buzzer, and keypad.
  *
- * This function should be called once at the beginning of main().
+ * This function should be called once at the beginning of main(). With
+ * PIANO_FAST_BOOT, main() brings up USB later, once the keypad is live.
  */
 void setup()
 {
-  stdio_init_all();
-  initBuzzerPWM();
-  initKeypad();
-  gpio_init(LED_RED_PIN);
-  gpio_set_dir(LED_RED_PIN, GPIO_OUT);
+  initScheduler();
+#if !PIANO_FAST_BOOT
+  initUsb();
+  initBuzzerPWM(); // Only playWelcomeTones() needs it
+#endif
+  initKeypadMatrix();
+#if KEYPAD_USE_PIO
+  initKeypadPio(KEYPAD_PIO_SCAN_HZ);
+#elif KEYPAD_USE_IRQ
+  initKeypadIrq();
+#endif
+  initLed();
+  debounceInit(&debouncer, DEBOUNCE_PRESS_SCANS, DEBOUNCE_RELEASE_SCANS);
+  keypadVelocityInit(&key_velocity);
+
+  consoleRegister('l', "print key-to-sound latency statistics", latencyDump);
+  consoleRegister('L', "reset latency statistics", latencyReset);
+  consoleRegister('t', "print telemetry counters and core load", telemetryDump);
+  consoleRegister('T', "reset telemetry counters", telemetryReset);
+  consoleRegister('u', "cycle tuning (equal 440, equal 432, just C)", cycleTuning);
+  consoleRegister('k', "cycle key layout", cycleKeymap);
+  consoleRegister('w', "cycle waveform (square, sine, triangle, saw, piano)", cycleWaveform);
+#if PIANO_POLYPHONIC && PIANO_SAMPLER
+  consoleRegister('i', "toggle instrument (synth, sample)", toggleSampler);
+#endif
+  consoleRegister('b', "print boot-to-first-scan time", bootDump);
+#if PIANO_RECORDER
+#if PIANO_POLYPHONIC
+  initRecorder(playExternalNote, audioFlashBegin, audioFlashEnd);
+#else
+  // The tone engine has no DMA to stop: its PWM keeps sounding the note.
+  initRecorder(playExternalNote, NULL, NULL);
+#endif
+  consoleRegister('r', "start/stop recording", toggleRecording);
+  consoleRegister('y', "start/stop looping the recording", togglePlayback);
+  consoleRegister('s', "save the recording to flash", saveRecording);
+#endif
+#if PIANO_METRONOME
+  initMetronome(playMetronomeNote);
+  consoleRegister('m', "start/stop the metronome", toggleMetronome);
+#endif
+#if PIANO_ARPEGGIATOR
+  initArp(playArpNote);
+  consoleRegister('a', "cycle arpeggiator (off, up, down, up-down)", cycleArp);
+#endif
+#if PIANO_METRONOME || PIANO_ARPEGGIATOR
+  consoleRegister('+', "tempo +10 BPM", tempoUp);
+  consoleRegister('-', "tempo -10 BPM", tempoDown);
+#endif
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+  initPower(lowPowerSleep, lowPowerWake);
+  consoleRegister('p', "print low-power idle statistics", powerDump);
+#endif
 }
 
-uint8_t row, col;
+/**
+ * @brief Reads the full key bitmap from the active scanner.
+ * @return Bit (row * 4 + col) is set for every pressed key
+ */
+uint16_t readKeys()
+{
+#if KEYPAD_USE_PIO
+  return keypadPioKeys();
+#else
+  return keypadMatrixRead();
+#endif
+}
+
+/**
+ * @brief Plays the notes for the key events of one scan.
+ * @param events Events reported by keypadEventsUpdate()
+ * @param detected_us time_us_32() when the events were first seen
+ * @param scan_us time_us_32() of the scan that accepted them
+ */
+void handleKeyEvents(const KeypadEvents *events, uint32_t detected_us, uint32_t scan_us)
+{
+#if PIANO_POLYPHONIC
+  // Each held key keeps its own voice until it is released.
+  for (uint8_t i = 0; i < events->release_count; i++)
+  {
+    audioNoteOff(events->release_list[i], detected_us);
+#if PIANO_USB_MIDI
+    usbMidiNoteOff(keyNote(events->release_list[i]));
+#endif
+#if PIANO_RECORDER
+    recorderNote(keyNote(events->release_list[i]), 0, detected_us);
+#endif
+  }
+  for (uint8_t i = 0; i < events->press_count; i++)
+  {
+    uint8_t key = events->press_list[i];
+    uint8_t note = pressKeyNote(key);
+#if PIANO_VELOCITY
+    uint8_t note_velocity = keypadVelocityPress(&key_velocity, key, scan_us);
+#else
+    uint8_t note_velocity = KEYPAD_VELOCITY_DEFAULT;
+    (void)scan_us;
+#endif
+#if PIANO_ARPEGGIATOR
+    // The arpeggiator plays the held keys itself.
+    if (arpMode() == ARP_OFF)
+#endif
+      audioNoteOn(key, note, note_velocity, detected_us);
+#if PIANO_USB_MIDI
+    usbMidiNoteOn(note, note_velocity);
+#endif
+#if PIANO_RECORDER
+    recorderNote(note, note_velocity, detected_us);
+#endif
+  }
+#else
+  (void)scan_us;
+  // The tone engine is monophonic: the highest newly pressed key wins and
+  // sounds until that key is released.
+  static int8_t tone_key = -1;
+  for (uint8_t i = 0; i < events->release_count; i++)
+  {
+#if PIANO_USB_MIDI
+    usbMidiNoteOff(keyNote(events->release_list[i]));
+#endif
+#if PIANO_RECORDER
+    recorderNote(keyNote(events->release_list[i]), 0, detected_us);
+#endif
+    if (events->release_list[i] == tone_key)
+    {
+      toneStop();
+      tone_key = -1;
+    }
+  }
+  for (uint8_t i = 0; i < events->press_count; i++)
+  {
+    uint8_t note = pressKeyNote(events->press_list[i]);
+#if PIANO_USB_MIDI
+    usbMidiNoteOn(note, KEYPAD_VELOCITY_DEFAULT);
+#endif
+#if PIANO_RECORDER
+    recorderNote(note, KEYPAD_VELOCITY_DEFAULT, detected_us);
+#endif
+#if !PIANO_USB_MIDI && !PIANO_RECORDER
+    (void)note;
+#endif
+  }
+  if (events->press_count > 0)
+  {
+    tone_key = (int8_t)events->press_list[events->press_count - 1];
+    toneStartNote(keyNote((uint8_t)tone_key), 0);
+    latencyRecord(LATENCY_KEY_TO_SOUND, time_us_32() - detected_us);
+    if (tone_wake_pending)
+    {
+      latencyRecord(LATENCY_WAKE_TO_SOUND, time_us_32() - detected_us);
+      tone_wake_pending = false;
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Switches layout or tuning when a key combo has just been completed.
+ *
+ * The combo keys play their notes as usual; the new layout applies from the
+ * next press.
+ * @param keys Debounced key bitmap after this scan's events
+ * @param events Events of this scan
+ */
+void handleKeyCombos(uint16_t keys, const KeypadEvents *events)
+{
+  if (events->press_count == 0)
+    return;
+  if (keys == KEYMAP_NEXT_LAYOUT_COMBO)
+    cycleKeymap();
+  else if (keys == KEYMAP_NEXT_TUNING_COMBO)
+    cycleTuning();
+}
 
 /**
  * @brief Main program entry point.
  *
  * Initializes peripherals and enters the main loop, scanning the keypad and playing tones.
+ * Notes play in the background (synthesizer or tone engine), so the keypad keeps
+ * being scanned while they sound. With AUDIO_DUAL_CORE the synthesizer runs on
+ * core 1 and this loop only posts note events to it. Every press and release of a scan is
+ * handled in the same pass, after the integrating debouncer (debounce.h). With KEYPAD_USE_IRQ the core sleeps between key
+ * presses and only polls while a key is held or bouncing; with PIANO_LOW_POWER it also
+ * clocks down after POWER_IDLE_TIMEOUT_MS without key activity. With PIANO_FAST_BOOT the
+ * loop starts while the welcome jingle is still playing, and USB comes up after its first
+ * scan pass.
  * @return int Program exit status (never returns in embedded context).
  */
 int main()
 {
   setup();
 
-  blink_led_red(1, 100);
+  ledBlink(1, 100);
+#if !PIANO_FAST_BOOT
   playWelcomeTones();
+#endif
+#if PIANO_POLYPHONIC
+  initAudio();
+#else
+  initToneEngine();
+#endif
+#if PIANO_FAST_BOOT
+  welcomePlay(playWelcomeNote);
+#endif
+#if PIANO_FAST_BOOT
+  // Brought up once the keypad has been scanned, off the path to it.
+  bool usb_pending = true;
+#else
+  bool usb_pending = false;
+#endif
 
+  // Time the change being debounced was first seen (edge or scan).
+  uint32_t detected_us = time_us_32();
+  boot_ready_us = detected_us;
   while (true)
   {
-    if (keypadScan(&row, &col))
+    uint32_t scan_us = time_us_32();
+#if KEYPAD_USE_IRQ
+    // Nothing to track while no key is held or bouncing: sleep until a
+    // column edge (or console input). The edge time is the true start of
+    // the key press. The first pass scans anyway, so USB is not left waiting
+    // for a key.
+    if (keys == 0 && debounceSettled(&debouncer) && !usb_pending)
+    {
+      uint32_t idle_start = time_us_32();
+      keypadIrqArm();
+#if PIANO_LOW_POWER
+      if (playingUnattended())
+        keypadIrqWait();
+      else
+        powerIdleWait();
+#else
+      keypadIrqWait();
+#endif
+      keypadIrqDisarm();
+      scan_us = keypadIrqPending() ? keypadIrqEdgeTime() : time_us_32();
+      telemetryIdle(0, scan_us - idle_start);
+    }
+#endif
+
+    if (debounceSettled(&debouncer))
+      detected_us = scan_us;
+    uint16_t raw = readKeys();
+    telemetryCount(TELEMETRY_SCANS);
+#if PIANO_VELOCITY
+    uint16_t settled_keys = debounceState(&debouncer);
+    uint16_t debounced = debounceUpdate(&debouncer, raw);
+    keypadVelocityScan(&key_velocity, raw, settled_keys, debounceCounting(&debouncer), scan_us);
+#else
+    uint16_t debounced = debounceUpdate(&debouncer, raw);
+#endif
+    if (keypadEventsUpdate(&keys, debounced, &events))
+    {
+      telemetryAdd(TELEMETRY_KEY_PRESSES, events.press_count);
+      telemetryAdd(TELEMETRY_KEY_RELEASES, events.release_count);
+#if PIANO_FAST_BOOT && !PIANO_POLYPHONIC
+      // The tone engine has one note: the first key press ends the jingle.
+      if (events.press_count > 0)
+        welcomeStop();
+#endif
+      handleKeyEvents(&events, detected_us, scan_us);
+      handleKeyCombos(keys, &events);
+#if PIANO_ARPEGGIATOR
+      arpSetKeys(keys, key_notes);
+#endif
+#if KEYPAD_USE_IRQ && PIANO_LOW_POWER
+      powerActivity();
+#endif
+      if (events.press_count > 0)
+        ledBlink(1, 50);
+    }
+    if (usb_pending)
     {
-      blink_led_red(1, 50);
-      playTone(keypad_freq_map[row][col], 200); // 200ms
+      initUsb();
+      usb_pending = false;
     }
-    sleep_ms(10); // Simple debounce
+    consolePoll();
+#if PIANO_RECORDER
+    recorderService();
+#endif
+    uint32_t idle_start = time_us_32();
+    sleep_us(KEYPAD_SCAN_PERIOD_US);
+    telemetryIdle(0, time_us_32() - idle_start);
   }
 }
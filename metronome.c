@@ -0,0 +1,83 @@
+/**
+ * @file metronome.c
+ * @brief Metronome clicks on the tick scheduler.
+ */
+#include "metronome.h"
+#include "scheduler.h"
+
+#define METRONOME_CLICK_US (METRONOME_CLICK_MS * 1000u)
+
+static MetronomeNoteFn metronome_play;
+static volatile uint32_t metronome_bpm = METRONOME_DEFAULT_BPM;
+static volatile SchedulerId metronome_event = 0;
+static uint32_t metronome_beat = 0;   //!< Beat within the bar
+static uint8_t metronome_note = 0;    //!< Click sounding, 0 if none
+
+/**
+ * @brief Scheduler callback: starts a click, or ends it and waits for the
+ * next beat.
+ */
+static uint32_t metronomeClickCallback(void *user_data)
+{
+  (void)user_data;
+  uint32_t beat_us = metronomeBeatUs();
+
+  if (metronome_note)
+  {
+    metronome_play(metronome_note, 0);
+    metronome_note = 0;
+    metronome_beat = (metronome_beat + 1) % METRONOME_BEATS_PER_BAR;
+    return beat_us > METRONOME_CLICK_US ? beat_us - METRONOME_CLICK_US : 1;
+  }
+
+  metronome_note = metronome_beat == 0 ? METRONOME_ACCENT_NOTE : METRONOME_NOTE;
+  metronome_play(metronome_note, metronome_beat == 0 ? METRONOME_ACCENT_VELOCITY : METRONOME_VELOCITY);
+  return METRONOME_CLICK_US;
+}
+
+void initMetronome(MetronomeNoteFn play)
+{
+  metronome_play = play;
+}
+
+void metronomeStart(void)
+{
+  metronomeStop();
+  metronome_beat = 0;
+  metronome_event = schedulerIn(0, metronomeClickCallback, NULL);
+}
+
+void metronomeStop(void)
+{
+  schedulerCancel(metronome_event);
+  metronome_event = 0;
+  if (metronome_note)
+  {
+    metronome_play(metronome_note, 0);
+    metronome_note = 0;
+  }
+}
+
+bool metronomeRunning(void)
+{
+  return metronome_event > 0;
+}
+
+void metronomeSetBpm(uint32_t bpm)
+{
+  if (bpm < METRONOME_MIN_BPM)
+    bpm = METRONOME_MIN_BPM;
+  if (bpm > METRONOME_MAX_BPM)
+    bpm = METRONOME_MAX_BPM;
+  metronome_bpm = bpm;
+}
+
+uint32_t metronomeBpm(void)
+{
+  return metronome_bpm;
+}
+
+uint32_t metronomeBeatUs(void)
+{
+  return 60000000u / metronome_bpm;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file metronome.h
+ * @brief Metronome clicks on the tick scheduler, and the tempo it shares
+ * with the arpeggiator.
+ *
+ * Each beat is a short note handed to a callback: an accented one on the
+ * first beat of the bar. Beats are scheduled relative to the previous
+ * deadline, so the metronome does not drift however late its IRQ runs, and
+ * a tempo change applies from the next beat.
+ */
+#ifndef METRONOME_H
+#define METRONOME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Tempo at start-up and its limits (beats per minute).
+ */
+#ifndef METRONOME_DEFAULT_BPM
+#define METRONOME_DEFAULT_BPM 120
+#endif
+#define METRONOME_MIN_BPM 30
+#define METRONOME_MAX_BPM 300
+
+/**
+ * @brief Beats per bar; the first is accented.
+ */
+#ifndef METRONOME_BEATS_PER_BAR
+#define METRONOME_BEATS_PER_BAR 4
+#endif
+
+/**
+ * @brief Click notes (MIDI) and velocities, and how long a click sounds (ms).
+ */
+#ifndef METRONOME_ACCENT_NOTE
+#define METRONOME_ACCENT_NOTE 96
+#endif
+#ifndef METRONOME_NOTE
+#define METRONOME_NOTE 84
+#endif
+#ifndef METRONOME_ACCENT_VELOCITY
+#define METRONOME_ACCENT_VELOCITY 127
+#endif
+#ifndef METRONOME_VELOCITY
+#define METRONOME_VELOCITY 100
+#endif
+#ifndef METRONOME_CLICK_MS
+#define METRONOME_CLICK_MS 20
+#endif
+
+/**
+ * @brief Plays a click (scheduler IRQ context).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ */
+typedef void (*MetronomeNoteFn)(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Sets the click callback; the metronome starts stopped.
+ * @param play Callback for clicks
+ */
+void initMetronome(MetronomeNoteFn play);
+
+/**
+ * @brief Starts clicking, with the accented beat now.
+ */
+void metronomeStart(void);
+
+/**
+ * @brief Stops clicking.
+ */
+void metronomeStop(void);
+
+/**
+ * @brief Checks whether the metronome is clicking.
+ */
+bool metronomeRunning(void);
+
+/**
+ * @brief Sets the tempo, clamped to METRONOME_MIN_BPM..METRONOME_MAX_BPM.
+ * @param bpm Beats per minute
+ */
+void metronomeSetBpm(uint32_t bpm);
+
+/**
+ * @brief The tempo in beats per minute.
+ */
+uint32_t metronomeBpm(void);
+
+/**
+ * @brief Length of one beat at the current tempo (us).
+ */
+uint32_t metronomeBeatUs(void);
+
+#endif // METRONOME_H
@@ -0,0 +1,59 @@
+/**
+ * @file mixer.h
+ * @brief Packed two-sample arithmetic for block mixing on the Cortex-M0+.
+ *
+ * The M0+ has no SIMD instructions, but a 32-bit word can still carry two
+ * signed 16-bit samples (lower address in the low half) if ordinary adds are
+ * kept from carrying between the halves. Mixing a voice into a block then
+ * costs one load and one store per two samples instead of per sample.
+ */
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+
+#define MIXER_SIGN_BITS 0x80008000u
+
+/**
+ * @brief Two adjacent int16_t samples viewed as one word (4-byte aligned).
+ */
+typedef uint32_t __attribute__((may_alias)) MixerPair;
+
+/**
+ * @brief Packs two samples into one word.
+ * @param first Sample at the lower address
+ * @param second Sample at the higher address
+ */
+static inline uint32_t mixerPack2(int32_t first, int32_t second)
+{
+  return (uint32_t)(uint16_t)first | ((uint32_t)second << 16);
+}
+
+/**
+ * @brief Adds two packed pairs, each half wrapping like an int16_t add.
+ *
+ * The low 15 bits of each half are added with the sign bits masked off, so
+ * a carry can only reach that half's own sign bit, which is then fixed up
+ * with an exclusive or.
+ */
+static inline uint32_t mixerAdd2(uint32_t a, uint32_t b)
+{
+  return ((a & ~MIXER_SIGN_BITS) + (b & ~MIXER_SIGN_BITS)) ^ ((a ^ b) & MIXER_SIGN_BITS);
+}
+
+/**
+ * @brief Adds two packed pairs, saturating each half to -32768..32767.
+ */
+static inline uint32_t mixerAddSat2(uint32_t a, uint32_t b)
+{
+  uint32_t sum = mixerAdd2(a, b);
+  // A half overflowed when both inputs had the same sign and the sum did not.
+  uint32_t overflow = ~(a ^ b) & (a ^ sum) & MIXER_SIGN_BITS;
+  if (overflow == 0)
+    return sum;
+  uint32_t lanes = (overflow >> 15) * 0xFFFFu;                      // 0xFFFF per overflowed half
+  uint32_t limit = 0x7FFF7FFFu + ((a & MIXER_SIGN_BITS) >> 15);    // 0x8000 if negative
+  return (sum & ~lanes) | (limit & lanes);
+}
+
+#endif // MIXER_H
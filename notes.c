@@ -0,0 +1,27 @@
+/**
+ * @file notes.c
+ * @brief Precomputed per-note playback parameters.
+ */
+#include "notes.h"
+
+static const NoteEntry *volatile note_active_table = note_tables[TUNING_EQUAL_440];
+
+void noteSetTuning(NoteTuning tuning)
+{
+  if (tuning < TUNING_COUNT)
+    note_active_table = note_tables[tuning];
+}
+
+NoteTuning noteTuning(void)
+{
+  return (NoteTuning)((note_active_table - note_tables[0]) / NOTE_COUNT);
+}
+
+const NoteEntry *noteEntry(uint8_t midi_note)
+{
+  if (midi_note < NOTE_MIDI_FIRST)
+    midi_note = NOTE_MIDI_FIRST;
+  else if (midi_note > NOTE_MIDI_LAST)
+    midi_note = NOTE_MIDI_LAST;
+  return &note_active_table[midi_note - NOTE_MIDI_FIRST];
+}
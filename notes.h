@@ -0,0 +1,65 @@
+/**
+ * @file notes.h
+ * @brief Precomputed per-note playback parameters.
+ *
+ * note_tables.c is generated by cmake/NoteTables.cmake for the configured
+ * sample rate and clk_sys: for every tuning and MIDI note it stores the
+ * synthesizer phase increment and the tone engine PWM divider/wrap, in flash.
+ * Playing a note is a table lookup, and switching tunings only swaps the
+ * active table pointer.
+ */
+#ifndef NOTES_H
+#define NOTES_H
+
+#include <stdint.h>
+
+#ifndef NOTE_MIDI_FIRST
+#define NOTE_MIDI_FIRST 24
+#endif
+
+#ifndef NOTE_MIDI_LAST
+#define NOTE_MIDI_LAST 108
+#endif
+
+#define NOTE_COUNT (NOTE_MIDI_LAST - NOTE_MIDI_FIRST + 1)
+
+/**
+ * @brief Supported tunings.
+ */
+typedef enum
+{
+  TUNING_EQUAL_440, //!< Equal temperament, A4 = 440 Hz
+  TUNING_EQUAL_432, //!< Equal temperament, A4 = 432 Hz
+  TUNING_JUST_C,    //!< 5-limit just intonation over C
+  TUNING_COUNT
+} NoteTuning;
+
+/**
+ * @brief Playback parameters of one note.
+ */
+typedef struct
+{
+  uint32_t phase_inc; //!< Synthesizer phase increment per sample (2^32 = one cycle)
+  uint16_t pwm_div16; //!< Tone engine PWM clock divider, 8.4 fixed point
+  uint16_t pwm_top;   //!< Tone engine PWM wrap value
+} NoteEntry;
+
+extern const NoteEntry note_tables[TUNING_COUNT][NOTE_COUNT];
+
+/**
+ * @brief Selects the tuning used by noteEntry(). A single pointer store.
+ */
+void noteSetTuning(NoteTuning tuning);
+
+/**
+ * @brief The active tuning.
+ */
+NoteTuning noteTuning(void);
+
+/**
+ * @brief Parameters of a MIDI note in the active tuning.
+ * @param midi_note MIDI note number, clamped to NOTE_MIDI_FIRST..NOTE_MIDI_LAST
+ */
+const NoteEntry *noteEntry(uint8_t midi_note);
+
+#endif // NOTES_H
@@ -0,0 +1,117 @@
+/**
+ * @file power.c
+ * @brief Low-power idle: clocks down after a period without key activity.
+ */
+#include "power.h"
+#include <stdio.h>
+#include "keypad_irq.h"
+#include "scheduler.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+#include "hardware/sync.h"
+
+#ifndef XOSC_HZ
+#define XOSC_HZ 12000000
+#endif
+
+static PowerHook power_on_sleep;
+static PowerHook power_on_wake;
+static absolute_time_t power_idle_deadline;
+static uint32_t power_sleeps = 0;
+static uint64_t power_asleep_us = 0;
+static uint32_t power_restore_us = 0;
+
+/**
+ * @brief Idle timeout: ends the full-clock wait (scheduler IRQ context).
+ */
+static uint32_t powerTimeoutCallback(void *user_data)
+{
+  (void)user_data;
+  keypadIrqWake();
+  return 0; // Do not reschedule
+}
+
+void initPower(PowerHook on_sleep, PowerHook on_wake)
+{
+  power_on_sleep = on_sleep;
+  power_on_wake = on_wake;
+  powerActivity();
+}
+
+void powerActivity(void)
+{
+  // Also called from IRQs (USB-MIDI input): the 64-bit store must not tear.
+  absolute_time_t deadline = make_timeout_time_ms(POWER_IDLE_TIMEOUT_MS);
+  uint32_t status = save_and_disable_interrupts();
+  power_idle_deadline = deadline;
+  restore_interrupts(status);
+}
+
+/**
+ * @brief Reads the idle deadline consistently with powerActivity().
+ */
+static absolute_time_t powerIdleDeadline(void)
+{
+  uint32_t status = save_and_disable_interrupts();
+  absolute_time_t deadline = power_idle_deadline;
+  restore_interrupts(status);
+  return deadline;
+}
+
+/**
+ * @brief Runs clk_sys (and clk_peri with it) from the crystal and stops the
+ * system PLL.
+ * @return clk_sys before clocking down
+ */
+static uint32_t powerClocksDown(void)
+{
+  uint32_t sys_hz = clock_get_hz(clk_sys);
+  clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0, XOSC_HZ, XOSC_HZ);
+  pll_deinit(pll_sys);
+  return sys_hz;
+}
+
+/**
+ * @brief Relocks the system PLL and moves clk_sys (and clk_peri) back to it.
+ */
+static void powerClocksUp(uint32_t sys_hz)
+{
+  set_sys_clock_khz(sys_hz / 1000, true);
+}
+
+void powerIdleWait(void)
+{
+  absolute_time_t deadline = powerIdleDeadline();
+  if (!time_reached(deadline))
+  {
+    SchedulerId timeout = schedulerAt(deadline, powerTimeoutCallback, NULL);
+    keypadIrqWait();
+    schedulerCancel(timeout);
+    if (keypadIrqPending() || !time_reached(powerIdleDeadline()))
+      return;
+  }
+
+  if (power_on_sleep)
+    power_on_sleep();
+  uint32_t sys_hz = powerClocksDown();
+  uint32_t asleep_us = time_us_32();
+
+  keypadIrqWait();
+
+  uint32_t wake_us = time_us_32();
+  powerClocksUp(sys_hz);
+  if (power_on_wake)
+    power_on_wake();
+
+  power_sleeps++;
+  power_asleep_us += wake_us - asleep_us;
+  power_restore_us = time_us_32() - wake_us;
+}
+
+void powerDump(void)
+{
+  printf("sleeps %lu, asleep %llu ms, last clock restore %lu us, idle timeout %d ms\n",
+         (unsigned long)power_sleeps, (unsigned long long)(power_asleep_us / 1000),
+         (unsigned long)power_restore_us, POWER_IDLE_TIMEOUT_MS);
+}
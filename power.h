@@ -0,0 +1,60 @@
+/**
+ * @file power.h
+ * @brief Low-power idle: clocks down after a period without key activity.
+ *
+ * While no key is held the main loop already sleeps in WFI until a column
+ * edge. Once POWER_IDLE_TIMEOUT_MS pass without key activity, powerIdleWait()
+ * also stops the audio output (through the sleep hook), switches clk_sys to
+ * the 12 MHz crystal and powers down the system PLL. The next column edge (or
+ * console input, or USB-MIDI input) restores the clock, then the wake hook
+ * restarts the audio.
+ * The timer, USB and the column edge IRQ keep running from their own clocks;
+ * the sleep hook also stops periodic timer work such as the USB frame tick, so
+ * only real input ends the WFI.
+ */
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Time without key activity before clocking down (ms).
+ */
+#ifndef POWER_IDLE_TIMEOUT_MS
+#define POWER_IDLE_TIMEOUT_MS 30000
+#endif
+
+/**
+ * @brief Called with full clocks just before clocking down, or just after
+ * restoring them.
+ */
+typedef void (*PowerHook)(void);
+
+/**
+ * @brief Starts the idle timer.
+ * @param on_sleep Stops whatever must not run on the slow clock (may be NULL)
+ * @param on_wake Restarts it once the clock is back (may be NULL)
+ */
+void initPower(PowerHook on_sleep, PowerHook on_wake);
+
+/**
+ * @brief Restarts the idle timer; call on every key event, or any other input
+ * that should keep full clocks (safe from IRQ context).
+ */
+void powerActivity(void);
+
+/**
+ * @brief Waits for the armed keypad (keypadIrqArm()) like keypadIrqWait(),
+ * clocking down once the idle timeout expires.
+ *
+ * Returns with full clocks on a column edge or console input.
+ */
+void powerIdleWait(void);
+
+/**
+ * @brief Prints sleep count, time asleep and the last clock restore time.
+ */
+void powerDump(void);
+
+#endif // POWER_H
@@ -0,0 +1,391 @@
+/**
+ * @file recorder.c
+ * @brief Note recorder and looper over a compact RAM ring, with optional
+ * persistence to a reserved flash area.
+ */
+#include "recorder.h"
+#include <stdio.h>
+#include "scheduler.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+#define RECORDER_RING_MASK (RECORDER_RING_BYTES - 1)
+#define RECORDER_NOTE_ON_BIT 0x80
+#define RECORDER_MAX_EVENT_BYTES 7 // 5-byte varint + note + velocity
+
+#define RECORDER_FLASH_MAGIC 0x31434552u // "REC1"
+#define RECORDER_FLASH_BYTES \
+  ((sizeof(RecorderFlashHeader) + RECORDER_RING_BYTES + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1))
+#define RECORDER_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - RECORDER_FLASH_BYTES)
+#define RECORDER_FLASH_SECTORS (RECORDER_FLASH_BYTES / FLASH_SECTOR_SIZE)
+
+/**
+ * @brief Start of the saved take in flash.
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t length;     //!< Bytes of event data following the header
+  uint32_t gap_ticks;  //!< Loop gap after the last event
+  uint32_t checksum;   //!< FNV-1a of the event data
+} RecorderFlashHeader;
+
+// cmake/RecorderFlash.cmake sizes the reserved flash area with this header.
+_Static_assert(sizeof(RecorderFlashHeader) == 16, "update cmake/RecorderFlash.cmake");
+
+/**
+ * @brief One decoded event.
+ */
+typedef struct
+{
+  uint32_t delta_ticks;
+  uint8_t note;
+  uint8_t velocity;
+} RecorderEvent;
+
+static uint8_t recorder_ring[RECORDER_RING_BYTES];
+static uint32_t recorder_head = 0; // Free-running byte indices
+static uint32_t recorder_tail = 0;
+static uint32_t recorder_gap_ticks = 1;
+static uint32_t recorder_last_us;
+static uint32_t recorder_held[4]; // Notes down while recording
+static volatile RecorderState recorder_state = RECORDER_IDLE;
+
+static RecorderNoteFn recorder_play;
+static RecorderFlashHook recorder_before_write;
+static RecorderFlashHook recorder_after_write;
+static bool recorder_loop;
+static volatile SchedulerId recorder_event = 0;
+static uint32_t recorder_play_pos;
+static RecorderEvent recorder_pending;
+static uint32_t recorder_sounding[4]; // Notes on during playback
+
+static RecorderFlashHeader recorder_save_header;
+static int recorder_save_sector = -1; // Next sector to write, -1 if idle
+
+/**
+ * @brief Parses the event starting at ring index pos.
+ * @return Index of the following event
+ */
+static uint32_t recorderDecode(uint32_t pos, RecorderEvent *event)
+{
+  uint32_t delta = 0;
+  uint8_t byte;
+  int shift = 0;
+  do
+  {
+    byte = recorder_ring[pos++ & RECORDER_RING_MASK];
+    delta |= (uint32_t)(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  byte = recorder_ring[pos++ & RECORDER_RING_MASK];
+  event->delta_ticks = delta;
+  event->note = byte & 0x7F;
+  event->velocity = (byte & RECORDER_NOTE_ON_BIT) ? recorder_ring[pos++ & RECORDER_RING_MASK] : 0;
+  return pos;
+}
+
+/**
+ * @brief Appends an encoded event, dropping the oldest events to make room.
+ */
+static void recorderAppend(uint32_t delta_ticks, uint8_t note, uint8_t velocity)
+{
+  uint8_t bytes[RECORDER_MAX_EVENT_BYTES];
+  uint32_t count = 0;
+  while (delta_ticks >= 0x80)
+  {
+    bytes[count++] = (uint8_t)(delta_ticks | 0x80);
+    delta_ticks >>= 7;
+  }
+  bytes[count++] = (uint8_t)delta_ticks;
+  if (velocity > 0)
+  {
+    bytes[count++] = (uint8_t)(note | RECORDER_NOTE_ON_BIT);
+    bytes[count++] = velocity;
+  }
+  else
+  {
+    bytes[count++] = note;
+  }
+
+  // The new first event's delta is never used: playback starts on it.
+  while (RECORDER_RING_BYTES - (recorder_head - recorder_tail) < count)
+  {
+    RecorderEvent dropped;
+    recorder_tail = recorderDecode(recorder_tail, &dropped);
+  }
+  for (uint32_t i = 0; i < count; i++)
+    recorder_ring[recorder_head++ & RECORDER_RING_MASK] = bytes[i];
+}
+
+static inline void recorderSetBit(uint32_t *bits, uint8_t note, bool on)
+{
+  if (on)
+    bits[note >> 5] |= 1u << (note & 31);
+  else
+    bits[note >> 5] &= ~(1u << (note & 31));
+}
+
+/**
+ * @brief Sends a note off for every note playback left on.
+ */
+static void recorderReleaseAll(void)
+{
+  for (uint8_t word = 0; word < 4; word++)
+  {
+    while (recorder_sounding[word])
+    {
+      uint8_t bit = (uint8_t)__builtin_ctz(recorder_sounding[word]);
+      recorder_sounding[word] &= recorder_sounding[word] - 1;
+      recorder_play((uint8_t)(word * 32 + bit), 0);
+    }
+  }
+}
+
+/**
+ * @brief Playback scheduler callback: plays every event now due and waits
+ * for the next.
+ */
+static uint32_t recorderPlayCallback(void *user_data)
+{
+  (void)user_data;
+
+  while (true)
+  {
+    recorder_play(recorder_pending.note, recorder_pending.velocity);
+    recorderSetBit(recorder_sounding, recorder_pending.note, recorder_pending.velocity > 0);
+
+    if (recorder_play_pos == recorder_head)
+    {
+      recorderReleaseAll();
+      if (!recorder_loop)
+      {
+        recorder_event = 0;
+        recorder_state = RECORDER_IDLE;
+        return 0;
+      }
+      // Start over after the gap the take ended with.
+      recorder_play_pos = recorderDecode(recorder_tail, &recorder_pending);
+      recorder_pending.delta_ticks = recorder_gap_ticks;
+    }
+    else
+    {
+      recorder_play_pos = recorderDecode(recorder_play_pos, &recorder_pending);
+    }
+
+    // Relative to the previous deadline, so the take keeps its tempo.
+    if (recorder_pending.delta_ticks > 0)
+      return recorder_pending.delta_ticks * RECORDER_TICK_US;
+  }
+}
+
+/**
+ * @brief Checks a header and its data in flash.
+ */
+static bool recorderFlashValid(const RecorderFlashHeader *header, const uint8_t *data)
+{
+  if (header->magic != RECORDER_FLASH_MAGIC || header->length == 0 ||
+      header->length > RECORDER_RING_BYTES)
+    return false;
+
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < header->length; i++)
+    hash = (hash ^ data[i]) * 16777619u;
+  return hash == header->checksum;
+}
+
+void initRecorder(RecorderNoteFn play, RecorderFlashHook before_write,
+                  RecorderFlashHook after_write)
+{
+  recorder_play = play;
+  recorder_before_write = before_write;
+  recorder_after_write = after_write;
+
+  const uint8_t *flash = (const uint8_t *)(XIP_BASE + RECORDER_FLASH_OFFSET);
+  const RecorderFlashHeader *header = (const RecorderFlashHeader *)flash;
+  const uint8_t *data = flash + sizeof(RecorderFlashHeader);
+  if (!recorderFlashValid(header, data))
+    return;
+
+  for (uint32_t i = 0; i < header->length; i++)
+    recorder_ring[i] = data[i];
+  recorder_tail = 0;
+  recorder_head = header->length;
+  recorder_gap_ticks = header->gap_ticks > 0 ? header->gap_ticks : 1;
+}
+
+bool recorderStart(void)
+{
+  if (recorder_save_sector >= 0)
+    return false;
+
+  recorderStop();
+  recorder_head = recorder_tail = 0;
+  for (int i = 0; i < 4; i++)
+    recorder_held[i] = 0;
+  recorder_last_us = time_us_32();
+  recorder_state = RECORDER_RECORDING;
+  return true;
+}
+
+void recorderStop(void)
+{
+  if (recorder_state == RECORDER_PLAYING)
+  {
+    schedulerCancel(recorder_event);
+    recorder_event = 0;
+    recorderReleaseAll();
+    recorder_state = RECORDER_IDLE;
+  }
+  else if (recorder_state == RECORDER_RECORDING)
+  {
+    uint32_t now = time_us_32();
+    for (uint8_t note = 0; note < 128; note++)
+    {
+      if (recorder_held[note >> 5] & (1u << (note & 31)))
+        recorderNote(note, 0, now);
+    }
+    // The note-offs above round recorder_last_us to a tick, which can put it
+    // up to half a tick past now: the difference must be taken signed.
+    int32_t gap_us = (int32_t)(time_us_32() - recorder_last_us);
+    recorder_gap_ticks = gap_us >= (int32_t)RECORDER_TICK_US ? (uint32_t)gap_us / RECORDER_TICK_US : 1;
+    recorder_state = RECORDER_IDLE;
+  }
+}
+
+void recorderNote(uint8_t note, uint8_t velocity, uint32_t time_us)
+{
+  if (recorder_state != RECORDER_RECORDING)
+    return;
+
+  note &= 0x7F;
+  // Ticks since the previous event, rounded and carried so errors don't add up.
+  uint32_t delta_ticks = (time_us - recorder_last_us + RECORDER_TICK_US / 2) / RECORDER_TICK_US;
+  recorder_last_us += delta_ticks * RECORDER_TICK_US;
+  recorderAppend(delta_ticks, note, velocity & 0x7F);
+  recorderSetBit(recorder_held, note, velocity > 0);
+}
+
+bool recorderPlay(bool loop)
+{
+  recorderStop();
+  if (recorder_head == recorder_tail || recorder_save_sector >= 0)
+    return false;
+
+  recorder_loop = loop;
+  for (int i = 0; i < 4; i++)
+    recorder_sounding[i] = 0;
+  recorder_play_pos = recorderDecode(recorder_tail, &recorder_pending);
+  recorder_state = RECORDER_PLAYING;
+  recorder_event = schedulerIn(RECORDER_TICK_US, recorderPlayCallback, NULL);
+  return true;
+}
+
+RecorderState recorderState(void)
+{
+  return recorder_state;
+}
+
+bool recorderSaving(void)
+{
+  return recorder_save_sector >= 0;
+}
+
+uint32_t recorderLength(void)
+{
+  return recorder_head - recorder_tail;
+}
+
+/**
+ * @brief Byte at offset of the flash image (header, then the take, then
+ * erased filler).
+ */
+static uint8_t __not_in_flash_func(recorderImageByte)(uint32_t offset)
+{
+  if (offset < sizeof(RecorderFlashHeader))
+    return ((const uint8_t *)&recorder_save_header)[offset];
+  offset -= sizeof(RecorderFlashHeader);
+  if (offset < recorder_save_header.length)
+    return recorder_ring[(recorder_tail + offset) & RECORDER_RING_MASK];
+  return 0xFF;
+}
+
+/**
+ * @brief Erases and programs one sector (runs with XIP off, from RAM).
+ */
+static void __not_in_flash_func(recorderWriteSector)(void *param)
+{
+  uint32_t sector = (uint32_t)(uintptr_t)param;
+  uint32_t base = sector * FLASH_SECTOR_SIZE;
+  uint8_t page[FLASH_PAGE_SIZE];
+
+  flash_range_erase(RECORDER_FLASH_OFFSET + base, FLASH_SECTOR_SIZE);
+  for (uint32_t p = 0; p < FLASH_SECTOR_SIZE; p += FLASH_PAGE_SIZE)
+  {
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++)
+      page[i] = recorderImageByte(base + p + i);
+    flash_range_program(RECORDER_FLASH_OFFSET + base + p, page, FLASH_PAGE_SIZE);
+  }
+}
+
+bool recorderSave(void)
+{
+  if (recorder_state != RECORDER_IDLE || recorder_save_sector >= 0)
+    return false;
+
+  uint32_t length = recorder_head - recorder_tail;
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < length; i++)
+    hash = (hash ^ recorder_ring[(recorder_tail + i) & RECORDER_RING_MASK]) * 16777619u;
+
+  recorder_save_header = (RecorderFlashHeader){
+      .magic = RECORDER_FLASH_MAGIC,
+      .length = length,
+      .gap_ticks = recorder_gap_ticks,
+      .checksum = hash,
+  };
+  recorder_save_sector = 0;
+  return true;
+}
+
+void recorderService(void)
+{
+  if (recorder_save_sector < 0)
+    return;
+
+  // Only touch sectors that differ from what flash already holds.
+  const uint8_t *flash = (const uint8_t *)(XIP_BASE + RECORDER_FLASH_OFFSET);
+  while (recorder_save_sector < (int)RECORDER_FLASH_SECTORS)
+  {
+    uint32_t base = (uint32_t)recorder_save_sector * FLASH_SECTOR_SIZE;
+    uint32_t i = 0;
+    while (i < FLASH_SECTOR_SIZE && flash[base + i] == recorderImageByte(base + i))
+      i++;
+    if (i < FLASH_SECTOR_SIZE)
+      break;
+    recorder_save_sector++;
+  }
+
+  if (recorder_save_sector >= (int)RECORDER_FLASH_SECTORS)
+  {
+    recorder_save_sector = -1;
+    printf("recorder: saved %lu bytes\n", (unsigned long)recorder_save_header.length);
+    return;
+  }
+
+  if (recorder_before_write)
+    recorder_before_write();
+  int result = flash_safe_execute(recorderWriteSector, (void *)(uintptr_t)recorder_save_sector,
+                                  RECORDER_FLASH_TIMEOUT_MS);
+  if (recorder_after_write)
+    recorder_after_write();
+  if (result != PICO_OK)
+  {
+    printf("recorder: flash write failed (%d)\n", result);
+    recorder_save_sector = -1;
+    return;
+  }
+  recorder_save_sector++;
+}
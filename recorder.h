@@ -0,0 +1,138 @@
+/**
+ * @file recorder.h
+ * @brief Note recorder and looper over a compact RAM ring, with optional
+ * persistence to a reserved flash area.
+ *
+ * Each note event is stored as a varint delta time in RECORDER_TICK_US ticks
+ * (one byte up to 127 ms), a byte holding the note number and on/off bit, and
+ * for note on a velocity byte: 2-4 bytes for typical playing. When the ring
+ * is full the oldest events are dropped. Playback runs from the tick
+ * scheduler (scheduler.h), like the tone and LED timers, and hands each note
+ * to a callback.
+ *
+ * Saving writes the take to the last RECORDER_FLASH_BYTES of flash, one
+ * erase sector per recorderService() call, so each stall is a single sector
+ * erase and program; sectors whose contents did not change are skipped to
+ * spare flash wear. Both cores are paused while a sector is written.
+ */
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Longest wait for the other core to pause before a flash write (ms).
+ */
+#ifndef RECORDER_FLASH_TIMEOUT_MS
+#define RECORDER_FLASH_TIMEOUT_MS 100
+#endif
+
+/**
+ * @brief Ring size in bytes (power of two).
+ */
+#ifndef RECORDER_RING_BYTES
+#define RECORDER_RING_BYTES 8192
+#endif
+
+#if (RECORDER_RING_BYTES & (RECORDER_RING_BYTES - 1)) != 0
+#error "RECORDER_RING_BYTES must be a power of two"
+#endif
+
+/**
+ * @brief Delta time resolution (us).
+ */
+#ifndef RECORDER_TICK_US
+#define RECORDER_TICK_US 1000
+#endif
+
+/**
+ * @brief Plays one recorded note (scheduler IRQ context).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ */
+typedef void (*RecorderNoteFn)(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Called just before and just after each flash sector write (thread
+ * context), e.g. to stop DMA that would play stale data meanwhile.
+ */
+typedef void (*RecorderFlashHook)(void);
+
+/**
+ * @brief Recorder states.
+ */
+typedef enum
+{
+  RECORDER_IDLE,
+  RECORDER_RECORDING,
+  RECORDER_PLAYING,
+} RecorderState;
+
+/**
+ * @brief Loads the take saved in flash, if any.
+ * @param play Callback for played notes
+ * @param before_write Runs before each sector write (may be NULL)
+ * @param after_write Runs after it (may be NULL)
+ */
+void initRecorder(RecorderNoteFn play, RecorderFlashHook before_write,
+                  RecorderFlashHook after_write);
+
+/**
+ * @brief Discards the current take and starts recording (stops playback).
+ * @return false while a save is in progress
+ */
+bool recorderStart(void);
+
+/**
+ * @brief Ends recording or playback.
+ *
+ * Notes still held when recording stops get a note off here, and the time
+ * since the last event becomes the gap before the loop restarts.
+ */
+void recorderStop(void);
+
+/**
+ * @brief Appends a note event while recording (thread context, core 0).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ * @param time_us time_us_32() of the event
+ */
+void recorderNote(uint8_t note, uint8_t velocity, uint32_t time_us);
+
+/**
+ * @brief Plays the take from its first event.
+ * @param loop true to repeat until recorderStop()
+ * @return false if there is nothing to play or a save is in progress
+ */
+bool recorderPlay(bool loop);
+
+/**
+ * @brief Current state.
+ */
+RecorderState recorderState(void);
+
+/**
+ * @brief Whether a save is still writing flash; recording and playback
+ * cannot start until it finishes.
+ */
+bool recorderSaving(void);
+
+/**
+ * @brief Bytes used by the current take.
+ */
+uint32_t recorderLength(void);
+
+/**
+ * @brief Starts saving the take to flash (when idle).
+ * @return false if recording/playing or a save is already running
+ */
+bool recorderSave(void);
+
+/**
+ * @brief Writes the next flash sector of a pending save; call from the main
+ * loop.
+ */
+void recorderService(void);
+
+#endif // RECORDER_H
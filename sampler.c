@@ -0,0 +1,459 @@
+/**
+ * @file sampler.c
+ * @brief Sampled-instrument voices streamed from flash.
+ */
+#include "sampler.h"
+#include "hot_path.h"
+#include <stddef.h>
+#include "audio_out.h"
+#include "envelope.h"
+#include "mixer.h"
+#include "notes.h"
+#include "synth.h"
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "hardware/dma.h"
+#include "hardware/structs/xip_ctrl.h"
+
+// Per-voice peak level, chosen so that all sample voices at once never clip.
+#define SAMPLER_VOICE_LEVEL (32767 / SAMPLER_VOICES)
+
+#define SAMPLER_RING_MASK (SAMPLER_RING_BYTES - 1)
+
+// Refills smaller than this wait until more of the ring is free (unless they
+// finish the recording), so the DMA setup cost is spread over enough data.
+#define SAMPLER_MIN_FETCH (SAMPLER_RING_BYTES / 4)
+
+// Each block may consume at most half a ring, which bounds the pitch shift
+// (8x, three octaves up, with the defaults).
+#define SAMPLER_MAX_INC ((uint32_t)(SAMPLER_RING_BYTES / 2 / AUDIO_BLOCK_SAMPLES) << 16)
+
+#if SAMPLER_RING_BYTES / 2 < AUDIO_BLOCK_SAMPLES
+#error "SAMPLER_RING_BYTES must be at least two bytes per sample of AUDIO_BLOCK_SAMPLES"
+#endif
+
+#if SAMPLER_FORMAT == SAMPLER_FORMAT_ADPCM
+#define SAMPLER_BYTES(samples) (((samples) + 1) / 2)
+#else
+#define SAMPLER_BYTES(samples) (samples)
+#endif
+
+// Linked from PIANO_SAMPLE_FILE by the build (word aligned, padded to words).
+extern const uint8_t sampler_data[];
+extern const uint8_t sampler_data_end[];
+
+/**
+ * @brief State of one sample voice.
+ */
+typedef struct
+{
+  uint32_t fetched;      //!< Bytes of the recording landed in the ring
+  uint32_t read;         //!< Samples decoded so far
+  uint32_t frac;         //!< Position between the last two decoded samples, 0.16
+  uint32_t inc;          //!< Position advance per output sample, 16.16
+  int32_t prev;          //!< Decoded sample before the position
+  int32_t cur;           //!< Decoded sample after the position
+  int32_t predictor;     //!< ADPCM decoder output
+  int32_t step_index;    //!< ADPCM step size index
+  uint32_t age;          //!< Note-on count when this voice was started
+  Envelope env;          //!< Amplitude envelope; the voice is free once idle
+  EnvelopeParams params; //!< Envelope shape scaled by the note velocity
+  uint8_t id;            //!< Note id this voice plays
+  bool gate;             //!< Key still held (not yet released)
+} SamplerVoice;
+
+static SamplerVoice sampler_voices[SAMPLER_VOICES];
+static uint8_t sampler_rings[SAMPLER_VOICES][SAMPLER_RING_BYTES]
+    __attribute__((aligned(SAMPLER_RING_BYTES)));
+static EnvelopeParams sampler_env_params;
+static uint32_t sampler_note_count = 0;
+static uint32_t sampler_data_bytes;
+static uint sampler_dma;
+static int8_t sampler_inflight = -1; //!< Voice the running refill is for, -1 if none
+static uint32_t sampler_inflight_bytes;
+static uint8_t sampler_next_refill = 0;
+static volatile uint32_t sampler_stalls = 0;
+
+// Taken around starting a refill, so samplerStreamPause() on the other core
+// cannot miss one that is being programmed.
+static critical_section_t sampler_stream_lock;
+static volatile bool sampler_stream_paused = false;
+
+#if SAMPLER_FORMAT == SAMPLER_FORMAT_ADPCM
+// Read for every decoded sample, so kept in SRAM next to the render code.
+static const int16_t sampler_adpcm_steps[89] __not_in_flash("sampler") = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,
+    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,
+    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,   230,   253,   279,
+    307,   337,   371,   408,   449,   494,   544,   598,   658,   724,   796,   876,   963,
+    1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,
+    3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t sampler_adpcm_index[8] __not_in_flash("sampler") = {-1, -1, -1, -1, 2, 4, 6, 8};
+#endif
+
+/**
+ * @brief Decodes the next sample of a voice from its ring, as signed 16-bit.
+ *
+ * This and the other per-sample helpers are always inlined, so no copy of
+ * them is left in flash outside the HOT_PATH_FUNC() callers.
+ */
+static inline __attribute__((always_inline)) int32_t samplerDecode(SamplerVoice *voice, const uint8_t *ring)
+{
+  uint32_t n = voice->read++;
+#if SAMPLER_FORMAT == SAMPLER_FORMAT_ADPCM
+  uint8_t code = ring[(n >> 1) & SAMPLER_RING_MASK];
+  code = (n & 1) ? (code >> 4) : (code & 0x0F);
+
+  int32_t step = sampler_adpcm_steps[voice->step_index];
+  int32_t diff = step >> 3;
+  if (code & 1)
+    diff += step >> 2;
+  if (code & 2)
+    diff += step >> 1;
+  if (code & 4)
+    diff += step;
+  voice->predictor += (code & 8) ? -diff : diff;
+  if (voice->predictor > 32767)
+    voice->predictor = 32767;
+  else if (voice->predictor < -32768)
+    voice->predictor = -32768;
+
+  voice->step_index += sampler_adpcm_index[code & 7];
+  if (voice->step_index < 0)
+    voice->step_index = 0;
+  else if (voice->step_index > 88)
+    voice->step_index = 88;
+  return voice->predictor;
+#else
+  return (int32_t)(int8_t)ring[n & SAMPLER_RING_MASK] << 8;
+#endif
+}
+
+/**
+ * @brief Credits a refill that has finished to its voice.
+ */
+static void HOT_PATH_FUNC(samplerCollect)(void)
+{
+  if (sampler_inflight < 0 || dma_channel_is_busy(sampler_dma))
+    return;
+  sampler_voices[sampler_inflight].fetched += sampler_inflight_bytes;
+  sampler_inflight = -1;
+}
+
+/**
+ * @brief Streams the next chunk of a voice's recording into its ring.
+ * @param v Voice index
+ * @param urgent Fetch even a small chunk, because the voice is waiting for it
+ * @return false if the voice has too little free ring space or nothing left
+ */
+static bool HOT_PATH_FUNC(samplerRefill)(uint8_t v, bool urgent)
+{
+  SamplerVoice *voice = &sampler_voices[v];
+  if (!envelopeActive(&voice->env) || voice->fetched >= sampler_data_bytes)
+    return false;
+
+  // Bytes behind the decoder may be overwritten; the one it is in may not.
+  uint32_t space = voice->read / (SAMPLER_FORMAT == SAMPLER_FORMAT_ADPCM ? 2 : 1) +
+                   SAMPLER_RING_BYTES - voice->fetched;
+  uint32_t left = sampler_data_bytes - voice->fetched;
+  uint32_t bytes = (space < left ? space : left) & ~3u;
+  if (bytes == 0 || (!urgent && bytes < SAMPLER_MIN_FETCH && bytes < left))
+    return false;
+
+  critical_section_enter_blocking(&sampler_stream_lock);
+  bool started = !sampler_stream_paused;
+  if (started)
+  {
+    // The stream FIFO may still hold words of an aborted transfer.
+    while (!(xip_ctrl_hw->stat & XIP_STAT_FIFO_EMPTY_BITS))
+      (void)xip_ctrl_hw->stream_fifo;
+    xip_ctrl_hw->stream_addr = (uint32_t)(uintptr_t)(sampler_data + voice->fetched);
+    xip_ctrl_hw->stream_ctr = bytes / 4;
+    dma_channel_set_write_addr(sampler_dma, &sampler_rings[v][voice->fetched & SAMPLER_RING_MASK], false);
+    dma_channel_set_trans_count(sampler_dma, bytes / 4, true);
+
+    sampler_inflight = (int8_t)v;
+    sampler_inflight_bytes = bytes;
+  }
+  critical_section_exit(&sampler_stream_lock);
+  return started;
+}
+
+/**
+ * @brief Collects a finished refill and starts the next one, round robin.
+ */
+static void HOT_PATH_FUNC(samplerService)(void)
+{
+  samplerCollect();
+  if (sampler_inflight >= 0)
+    return;
+  for (uint8_t i = 0; i < SAMPLER_VOICES; i++)
+  {
+    uint8_t v = (uint8_t)((sampler_next_refill + i) % SAMPLER_VOICES);
+    if (samplerRefill(v, false))
+    {
+      sampler_next_refill = (uint8_t)((v + 1) % SAMPLER_VOICES);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Waits for the running refill, if any, and credits it.
+ */
+static void samplerSettle(void)
+{
+  if (sampler_inflight < 0)
+    return;
+  dma_channel_wait_for_finish_blocking(sampler_dma);
+  samplerCollect();
+}
+
+void initSampler(void)
+{
+  sampler_data_bytes = (uint32_t)(sampler_data_end - sampler_data);
+  critical_section_init(&sampler_stream_lock);
+  envelopeSetParams(&sampler_env_params, SAMPLER_VOICE_LEVEL, 1, 0, 100, SYNTH_RELEASE_MS,
+                    SYNTH_SAMPLE_RATE);
+
+  sampler_dma = (uint)dma_claim_unused_channel(true);
+  dma_channel_config config = dma_channel_get_default_config(sampler_dma);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+  channel_config_set_read_increment(&config, false);
+  channel_config_set_write_increment(&config, true);
+  channel_config_set_ring(&config, true, (uint)__builtin_ctz(SAMPLER_RING_BYTES));
+  channel_config_set_dreq(&config, DREQ_XIP_STREAM);
+  dma_channel_configure(sampler_dma, &config, sampler_rings[0], (const void *)XIP_AUX_BASE, 0, false);
+
+  samplerAllNotesOff();
+}
+
+void samplerNoteOn(uint8_t id, uint8_t midi_note, uint8_t velocity)
+{
+  // A free voice, the one already playing this id, or the oldest.
+  SamplerVoice *voice = NULL;
+  for (uint8_t v = 0; v < SAMPLER_VOICES; v++)
+  {
+    SamplerVoice *candidate = &sampler_voices[v];
+    if (envelopeActive(&candidate->env) && candidate->id == id)
+    {
+      voice = candidate;
+      break;
+    }
+    if (voice == NULL || !envelopeActive(&candidate->env) ||
+        (envelopeActive(&voice->env) && (int32_t)(candidate->age - voice->age) < 0))
+      voice = candidate;
+  }
+
+  // Restarting from the top of the recording discards the ring contents,
+  // including a refill still landing in it.
+  samplerSettle();
+  voice->fetched = 0;
+  voice->read = 0;
+  voice->frac = 0;
+  voice->prev = 0;
+  voice->cur = 0;
+  voice->predictor = 0;
+  voice->step_index = 0;
+
+  // Relative pitch from the tuning tables, so samples follow the tuning too.
+  uint64_t ratio = ((uint64_t)noteEntry(midi_note)->phase_inc * SAMPLER_SOURCE_RATE) << 16;
+  uint32_t inc = (uint32_t)(ratio / ((uint64_t)noteEntry(SAMPLER_ROOT_NOTE)->phase_inc * SYNTH_SAMPLE_RATE));
+  voice->inc = inc < SAMPLER_MAX_INC ? inc : SAMPLER_MAX_INC;
+
+  voice->id = id;
+  voice->gate = true;
+  voice->age = ++sampler_note_count;
+  envelopeReset(&voice->env);
+  envelopeScaleParams(&voice->params, &sampler_env_params, (uint32_t)(velocity & 0x7F) + 1);
+  envelopeGateOn(&voice->env, &voice->params);
+
+  // The first ring fill; rendering waits for it on this voice only.
+  samplerRefill((uint8_t)(voice - sampler_voices), true);
+}
+
+void samplerNoteOff(uint8_t id)
+{
+  for (uint8_t v = 0; v < SAMPLER_VOICES; v++)
+  {
+    SamplerVoice *voice = &sampler_voices[v];
+    if (voice->gate && voice->id == id)
+    {
+      voice->gate = false;
+      envelopeGateOff(&voice->env, &voice->params);
+    }
+  }
+}
+
+void samplerAllNotesOff(void)
+{
+  samplerSettle();
+  for (uint8_t v = 0; v < SAMPLER_VOICES; v++)
+  {
+    envelopeReset(&sampler_voices[v].env);
+    sampler_voices[v].gate = false;
+  }
+}
+
+uint8_t samplerActiveVoices(void)
+{
+  uint8_t count = 0;
+  for (uint8_t v = 0; v < SAMPLER_VOICES; v++)
+    count += envelopeActive(&sampler_voices[v].env);
+  return count;
+}
+
+/**
+ * @brief Makes sure the ring holds every byte count samples will decode.
+ */
+static void HOT_PATH_FUNC(samplerEnsure)(uint8_t v, uint32_t count)
+{
+  SamplerVoice *voice = &sampler_voices[v];
+  uint32_t samples = (uint32_t)(((uint64_t)voice->frac + (uint64_t)voice->inc * count) >> 16);
+  uint32_t needed = SAMPLER_BYTES(voice->read + samples);
+  if (needed > sampler_data_bytes)
+    needed = sampler_data_bytes;
+
+  if (voice->fetched >= needed)
+    return;
+  // Waiting for the first fill after a note on is expected; later it is not.
+  if (voice->read > 0)
+    sampler_stalls++;
+  samplerSettle();
+  while (voice->fetched < needed && samplerRefill(v, true))
+    samplerSettle();
+}
+
+/**
+ * @brief Steps a voice by one output sample.
+ * @param sample Receives the sample scaled by gain
+ * @return false once the recording has run out (the note is then ended)
+ */
+static inline __attribute__((always_inline)) bool samplerNext(SamplerVoice *voice,
+                                                             const uint8_t *ring, int32_t gain,
+                                                             int32_t *sample)
+{
+  voice->frac += voice->inc;
+  while (voice->frac >= 0x10000)
+  {
+    if (SAMPLER_BYTES(voice->read + 1) > sampler_data_bytes)
+    {
+      envelopeReset(&voice->env);
+      return false;
+    }
+    voice->frac -= 0x10000;
+    voice->prev = voice->cur;
+    voice->cur = samplerDecode(voice, ring);
+  }
+
+  int32_t value = voice->prev + (((voice->cur - voice->prev) * (int32_t)(voice->frac >> 1)) >> 15);
+  *sample = (value * gain) >> 15;
+  return true;
+}
+
+/**
+ * @brief Adds one sample to the output, saturating.
+ */
+static inline __attribute__((always_inline)) void samplerMixOne(int16_t *out, int32_t sample)
+{
+  int32_t mixed = *out + sample;
+  *out = (int16_t)(mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed));
+}
+
+/**
+ * @brief Adds one voice over count samples, one envelope segment at a time.
+ *
+ * Sample voices are full scale, so unlike synth voices they can overflow the
+ * mix; the aligned middle of each segment is added two samples at a time
+ * with a saturating packed add.
+ */
+static void HOT_PATH_FUNC(samplerRenderVoice)(uint8_t v, int16_t *out, uint32_t count)
+{
+  SamplerVoice *voice = &sampler_voices[v];
+  const uint8_t *ring = sampler_rings[v];
+  int32_t first;
+  int32_t second;
+
+  samplerEnsure(v, count);
+  while (count > 0 && envelopeActive(&voice->env))
+  {
+    uint32_t segment = envelopeSegment(&voice->env, count);
+    uint32_t level = voice->env.level;
+    uint32_t step = (uint32_t)voice->env.step;
+    uint32_t i = 0;
+
+    if ((uintptr_t)out & 2)
+    {
+      if (!samplerNext(voice, ring, (int32_t)(level >> 16), &first))
+        return;
+      samplerMixOne(&out[i++], first);
+      level += step;
+    }
+    for (; i + 1 < segment; i += 2)
+    {
+      if (!samplerNext(voice, ring, (int32_t)(level >> 16), &first))
+        return;
+      level += step;
+      if (!samplerNext(voice, ring, (int32_t)(level >> 16), &second))
+      {
+        samplerMixOne(&out[i], first); // The recording ended between the two
+        return;
+      }
+      level += step;
+      MixerPair *pair = (MixerPair *)&out[i];
+      *pair = mixerAddSat2(*pair, mixerPack2(first, second));
+    }
+    if (i < segment)
+    {
+      if (!samplerNext(voice, ring, (int32_t)(level >> 16), &first))
+        return;
+      samplerMixOne(&out[i], first);
+      level += step;
+    }
+
+    voice->env.level = level;
+    envelopeAdvance(&voice->env, &voice->params, segment);
+    out += segment;
+    count -= segment;
+  }
+}
+
+void HOT_PATH_FUNC(samplerRenderBlock)(int16_t *out, uint32_t count)
+{
+  for (uint8_t v = 0; v < SAMPLER_VOICES; v++)
+  {
+    if (envelopeActive(&sampler_voices[v].env))
+      samplerRenderVoice(v, out, count);
+  }
+  samplerService();
+}
+
+uint32_t samplerStalls(void)
+{
+  return sampler_stalls;
+}
+
+uint32_t samplerDataBytes(void)
+{
+  return sampler_data_bytes;
+}
+
+void samplerStreamPause(void)
+{
+  critical_section_enter_blocking(&sampler_stream_lock);
+  sampler_stream_paused = true;
+  critical_section_exit(&sampler_stream_lock);
+
+  // Nothing starts after this; the running chunk (at most one ring) lands
+  // by itself and is credited by the audio core as usual.
+  while (dma_channel_is_busy(sampler_dma))
+    tight_loop_contents();
+}
+
+void samplerStreamResume(void)
+{
+  sampler_stream_paused = false;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file sampler.h
+ * @brief Sampled-instrument voices streamed from flash.
+ *
+ * The instrument is one mono recording linked into its own flash section
+ * (cmake: PIANO_SAMPLE_FILE), either signed 8-bit PCM or 4-bit IMA ADPCM, far
+ * larger than SRAM. Each voice keeps a small SRAM ring of upcoming bytes. The
+ * ring is refilled by DMA from the XIP streaming interface, which reads flash
+ * without going through the XIP cache, so playing long samples does not
+ * evict the code and tables the keypad and synthesizer paths run from.
+ *
+ * Voices are pitched from the recording's root note with the active tuning
+ * (notes.h), linearly interpolated, and shaped by the synthesizer's ADSR
+ * envelope (envelope.h); a note also ends when the recording does.
+ */
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Sample encodings.
+ */
+#define SAMPLER_FORMAT_PCM8 0  //!< Signed 8-bit PCM
+#define SAMPLER_FORMAT_ADPCM 1 //!< IMA ADPCM, 4 bits per sample, low nibble first
+
+#ifndef SAMPLER_FORMAT
+#define SAMPLER_FORMAT SAMPLER_FORMAT_PCM8
+#endif
+
+/**
+ * @brief MIDI note at which the recording plays at its original pitch.
+ */
+#ifndef SAMPLER_ROOT_NOTE
+#define SAMPLER_ROOT_NOTE 60
+#endif
+
+/**
+ * @brief Sample rate of the recording, in Hz.
+ */
+#ifndef SAMPLER_SOURCE_RATE
+#define SAMPLER_SOURCE_RATE 25000
+#endif
+
+/**
+ * @brief Simultaneous sample voices (1-4).
+ */
+#ifndef SAMPLER_VOICES
+#define SAMPLER_VOICES 2
+#endif
+
+/**
+ * @brief Bytes of SRAM buffer per voice (power of two, at least 256).
+ */
+#ifndef SAMPLER_RING_BYTES
+#define SAMPLER_RING_BYTES 1024
+#endif
+
+#if SAMPLER_VOICES < 1 || SAMPLER_VOICES > 4
+#error "SAMPLER_VOICES must be between 1 and 4"
+#endif
+
+#if SAMPLER_RING_BYTES < 256 || (SAMPLER_RING_BYTES & (SAMPLER_RING_BYTES - 1))
+#error "SAMPLER_RING_BYTES must be a power of two of at least 256"
+#endif
+
+/**
+ * @brief Claims the streaming DMA channel and silences all voices.
+ *
+ * Call on the core that renders audio.
+ */
+void initSampler(void);
+
+/**
+ * @brief Starts the recording at a note's pitch on a free (or the oldest)
+ * voice.
+ * @param id Caller-chosen note identifier, as for synthNoteOn()
+ * @param midi_note MIDI note number
+ * @param velocity MIDI velocity 1..127
+ */
+void samplerNoteOn(uint8_t id, uint8_t midi_note, uint8_t velocity);
+
+/**
+ * @brief Releases the voice playing a note id, if any.
+ */
+void samplerNoteOff(uint8_t id);
+
+/**
+ * @brief Silences every voice immediately.
+ */
+void samplerAllNotesOff(void);
+
+/**
+ * @brief Number of sample voices sounding.
+ */
+uint8_t samplerActiveVoices(void);
+
+/**
+ * @brief Adds the sample voices to count samples of out (saturating), then
+ * starts the next ring refill.
+ *
+ * Waits for a refill still in flight only if a voice would otherwise read
+ * past the data that has arrived.
+ */
+void samplerRenderBlock(int16_t *out, uint32_t count);
+
+/**
+ * @brief Ring refills that had not landed when a voice needed them.
+ */
+uint32_t samplerStalls(void);
+
+/**
+ * @brief Length of the linked recording in bytes.
+ */
+uint32_t samplerDataBytes(void);
+
+/**
+ * @brief Stops starting ring refills and waits for the one in flight, so the
+ * XIP stream is idle before flash is erased or programmed.
+ *
+ * Safe to call from the other core. Until samplerStreamResume(), voices that
+ * run out of fetched data play stale ring contents instead of waiting.
+ */
+void samplerStreamPause(void);
+
+/**
+ * @brief Lets ring refills start again after samplerStreamPause().
+ */
+void samplerStreamResume(void);
+
+#endif // SAMPLER_H
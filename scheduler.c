@@ -0,0 +1,226 @@
+/**
+ * @file scheduler.c
+ * @brief Timed callbacks dispatched from a single hardware alarm.
+ */
+#include "scheduler.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#define SCHEDULER_SLOT_BITS 5
+#define SCHEDULER_SLOT_MASK ((1u << SCHEDULER_SLOT_BITS) - 1)
+#define SCHEDULER_NO_SLOT 0xFF
+
+/**
+ * @brief One event slot.
+ */
+typedef struct
+{
+  uint64_t deadline;           //!< time_us_64() at which to call
+  SchedulerCallback callback;
+  void *user_data;
+  SchedulerId id;              //!< Handle while allocated
+  uint8_t position;            //!< Index in scheduler_heap
+} SchedulerEvent;
+
+static SchedulerEvent scheduler_events[SCHEDULER_MAX_EVENTS];
+static uint8_t scheduler_heap[SCHEDULER_MAX_EVENTS]; //!< Slots, earliest deadline first
+static uint8_t scheduler_count = 0;
+static uint32_t scheduler_free_mask =
+    (SCHEDULER_MAX_EVENTS == 32) ? 0xFFFFFFFFu : ((1u << SCHEDULER_MAX_EVENTS) - 1);
+static uint32_t scheduler_serial = 0;
+static uint scheduler_alarm;
+static uint8_t scheduler_running = SCHEDULER_NO_SLOT; //!< Slot whose callback is running
+static bool scheduler_running_cancelled;
+
+static inline bool schedulerBefore(uint8_t a, uint8_t b)
+{
+  return scheduler_events[a].deadline < scheduler_events[b].deadline;
+}
+
+static inline void schedulerPlace(uint8_t position, uint8_t slot)
+{
+  scheduler_heap[position] = slot;
+  scheduler_events[slot].position = position;
+}
+
+static void schedulerSiftUp(uint8_t position)
+{
+  uint8_t slot = scheduler_heap[position];
+  while (position > 0)
+  {
+    uint8_t parent = (uint8_t)((position - 1) / 2);
+    if (!schedulerBefore(slot, scheduler_heap[parent]))
+      break;
+    schedulerPlace(position, scheduler_heap[parent]);
+    position = parent;
+  }
+  schedulerPlace(position, slot);
+}
+
+static void schedulerSiftDown(uint8_t position)
+{
+  uint8_t slot = scheduler_heap[position];
+  while (true)
+  {
+    uint32_t child = 2u * position + 1;
+    if (child >= scheduler_count)
+      break;
+    if (child + 1 < scheduler_count && schedulerBefore(scheduler_heap[child + 1], scheduler_heap[child]))
+      child++;
+    if (!schedulerBefore(scheduler_heap[child], slot))
+      break;
+    schedulerPlace(position, scheduler_heap[child]);
+    position = (uint8_t)child;
+  }
+  schedulerPlace(position, slot);
+}
+
+static void schedulerInsert(uint8_t slot)
+{
+  schedulerPlace(scheduler_count, slot);
+  scheduler_count++;
+  schedulerSiftUp(scheduler_events[slot].position);
+}
+
+static void schedulerRemove(uint8_t position)
+{
+  scheduler_count--;
+  if (position == scheduler_count)
+    return;
+  schedulerPlace(position, scheduler_heap[scheduler_count]);
+  schedulerSiftDown(position);
+  schedulerSiftUp(scheduler_events[scheduler_heap[position]].position);
+}
+
+static inline void schedulerFreeSlot(uint8_t slot)
+{
+  scheduler_events[slot].id = 0;
+  scheduler_free_mask |= 1u << slot;
+}
+
+/**
+ * @brief Points the alarm at the earliest deadline (interrupts masked).
+ */
+static void schedulerArm(void)
+{
+  if (scheduler_count == 0)
+  {
+    hardware_alarm_cancel(scheduler_alarm);
+    return;
+  }
+  // A deadline that passed while this ran is not set: take the IRQ anyway.
+  absolute_time_t target = from_us_since_boot(scheduler_events[scheduler_heap[0]].deadline);
+  if (hardware_alarm_set_target(scheduler_alarm, target))
+    hardware_alarm_force_irq(scheduler_alarm);
+}
+
+/**
+ * @brief Alarm IRQ: runs every callback now due, then rearms.
+ *
+ * Callbacks run with interrupts enabled and may schedule or cancel events.
+ */
+static void schedulerAlarmCallback(uint alarm_num)
+{
+  (void)alarm_num;
+  uint32_t status = save_and_disable_interrupts();
+  while (scheduler_count > 0 && scheduler_events[scheduler_heap[0]].deadline <= time_us_64())
+  {
+    uint8_t slot = scheduler_heap[0];
+    SchedulerEvent *event = &scheduler_events[slot];
+    schedulerRemove(0);
+    scheduler_running = slot;
+    scheduler_running_cancelled = false;
+    restore_interrupts(status);
+
+    uint32_t next_us = event->callback(event->user_data);
+
+    status = save_and_disable_interrupts();
+    scheduler_running = SCHEDULER_NO_SLOT;
+    if (next_us > 0 && !scheduler_running_cancelled)
+    {
+      event->deadline += next_us;
+      schedulerInsert(slot);
+    }
+    else
+    {
+      schedulerFreeSlot(slot);
+    }
+  }
+  schedulerArm();
+  restore_interrupts(status);
+}
+
+void initScheduler(void)
+{
+  scheduler_alarm = (uint)hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(scheduler_alarm, schedulerAlarmCallback);
+}
+
+SchedulerId schedulerAt(absolute_time_t deadline, SchedulerCallback callback, void *user_data)
+{
+  uint32_t status = save_and_disable_interrupts();
+  if (scheduler_free_mask == 0)
+  {
+    restore_interrupts(status);
+    return 0;
+  }
+
+  uint8_t slot = (uint8_t)__builtin_ctz(scheduler_free_mask);
+  scheduler_free_mask &= ~(1u << slot);
+  scheduler_serial = (scheduler_serial + 1) & (0x7FFFFFFFu >> SCHEDULER_SLOT_BITS);
+  if (scheduler_serial == 0)
+    scheduler_serial = 1;
+
+  SchedulerEvent *event = &scheduler_events[slot];
+  event->deadline = to_us_since_boot(deadline);
+  event->callback = callback;
+  event->user_data = user_data;
+  event->id = (SchedulerId)((scheduler_serial << SCHEDULER_SLOT_BITS) | slot);
+  schedulerInsert(slot);
+  if (event->position == 0)
+    schedulerArm();
+
+  SchedulerId id = event->id;
+  restore_interrupts(status);
+  return id;
+}
+
+SchedulerId schedulerIn(uint32_t delay_us, SchedulerCallback callback, void *user_data)
+{
+  return schedulerAt(make_timeout_time_us(delay_us), callback, user_data);
+}
+
+bool schedulerCancel(SchedulerId id)
+{
+  if (id <= 0)
+    return false;
+
+  uint8_t slot = (uint8_t)(id & SCHEDULER_SLOT_MASK);
+  if (slot >= SCHEDULER_MAX_EVENTS)
+    return false;
+
+  uint32_t status = save_and_disable_interrupts();
+  bool pending = scheduler_events[slot].id == id;
+  if (pending && slot == scheduler_running)
+  {
+    // Freed by the dispatcher once the callback returns.
+    pending = !scheduler_running_cancelled;
+    scheduler_running_cancelled = true;
+  }
+  else if (pending)
+  {
+    bool first = scheduler_events[slot].position == 0;
+    schedulerRemove(scheduler_events[slot].position);
+    schedulerFreeSlot(slot);
+    if (first)
+      schedulerArm();
+  }
+  restore_interrupts(status);
+  return pending;
+}
+
+uint32_t schedulerPending(void)
+{
+  return scheduler_count;
+}
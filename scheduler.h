@@ -0,0 +1,86 @@
+/**
+ * @file scheduler.h
+ * @brief Timed callbacks dispatched from a single hardware alarm.
+ *
+ * Pending deadlines sit in a small min-heap and the alarm is always set for
+ * the earliest one, so every timed feature (note lengths, LED patterns,
+ * recorder playback, metronome, arpeggiator, the USB frame tick, the idle
+ * timeout) shares one timer IRQ, and adding or cancelling an event costs
+ * O(log n) however many are pending.
+ *
+ * Callbacks run in that timer IRQ. Schedule and cancel from the core that
+ * called initScheduler() (thread code or its IRQs); the heap is guarded by
+ * masking interrupts, not by a lock between cores.
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief Events that can be pending at once (up to 32).
+ */
+#ifndef SCHEDULER_MAX_EVENTS
+#define SCHEDULER_MAX_EVENTS 16
+#endif
+
+#if SCHEDULER_MAX_EVENTS < 1 || SCHEDULER_MAX_EVENTS > 32
+#error "SCHEDULER_MAX_EVENTS must be between 1 and 32"
+#endif
+
+/**
+ * @brief Handle of a scheduled event; always > 0, and not reused for
+ * millions of later events, so cancelling a finished one is harmless.
+ */
+typedef int32_t SchedulerId;
+
+/**
+ * @brief Event callback (timer IRQ context).
+ * @param user_data Pointer given when the event was scheduled
+ * @return 0 to finish, or the time in us from this deadline (not from now)
+ * to the next call, so periodic events keep their pace
+ */
+typedef uint32_t (*SchedulerCallback)(void *user_data);
+
+/**
+ * @brief Claims the hardware alarm; call before scheduling anything.
+ */
+void initScheduler(void);
+
+/**
+ * @brief Schedules a callback at an absolute time.
+ *
+ * A deadline already past runs as soon as the timer IRQ can be taken.
+ * @param deadline When to call
+ * @param callback Function to call
+ * @param user_data Passed to callback
+ * @return Event handle, or 0 if SCHEDULER_MAX_EVENTS are already pending
+ */
+SchedulerId schedulerAt(absolute_time_t deadline, SchedulerCallback callback, void *user_data);
+
+/**
+ * @brief Schedules a callback after a delay from now.
+ * @param delay_us Delay in us
+ * @param callback Function to call
+ * @param user_data Passed to callback
+ * @return Event handle, or 0 if SCHEDULER_MAX_EVENTS are already pending
+ */
+SchedulerId schedulerIn(uint32_t delay_us, SchedulerCallback callback, void *user_data);
+
+/**
+ * @brief Cancels a pending event.
+ *
+ * Cancelling from inside its own callback stops it from being rescheduled.
+ * @param id Handle from schedulerAt()/schedulerIn() (0 is ignored)
+ * @return true if the event was still pending
+ */
+bool schedulerCancel(SchedulerId id);
+
+/**
+ * @brief Number of events pending.
+ */
+uint32_t schedulerPending(void);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,529 @@
+/**
+ * @file synth.c
+ * @brief Polyphonic software synthesizer.
+ */
+#include "synth.h"
+#include "hot_path.h"
+#include <stddef.h>
+#include <string.h>
+#include "envelope.h"
+#include "mixer.h"
+#include "wavetable.h"
+
+// The interpolator is per-core SIO hardware; off target the C path is used.
+#if SYNTH_USE_INTERP && !(defined(PICO_ON_DEVICE) && PICO_ON_DEVICE)
+#undef SYNTH_USE_INTERP
+#define SYNTH_USE_INTERP 0
+#endif
+
+#if SYNTH_USE_INTERP
+#include "hardware/interp.h"
+#endif
+
+// Per-voice peak level, chosen so that all voices at once never clip.
+#define SYNTH_VOICE_LEVEL (32767 / SYNTH_MAX_VOICES)
+
+#define SYNTH_ALL_VOICES ((1u << SYNTH_MAX_VOICES) - 1)
+
+/**
+ * @brief State of one oscillator voice.
+ */
+typedef struct
+{
+  uint32_t phase;           //!< Phase accumulator, one cycle per 2^32
+  uint32_t phase_inc;       //!< Phase advance per output sample
+  const int16_t *table;     //!< Wavetable, or NULL for a square wave
+  Envelope env;             //!< Amplitude envelope; the voice is free once idle
+  EnvelopeParams params;    //!< Envelope shape scaled by the note velocity
+  uint32_t age;             //!< Note-on count when this voice was started
+  uint8_t id;               //!< Note id this voice plays
+  bool gate;                //!< Key still held (not yet released)
+} SynthVoice;
+
+static SynthVoice synth_voices[SYNTH_MAX_VOICES];
+
+// Voice allocation state, one bit per voice: free voices (envelope idle) and
+// sounding voices whose key is released. Together with the id map below they
+// make note on/off constant time; only stealing looks at several voices.
+static uint32_t synth_free_mask = SYNTH_ALL_VOICES;
+static uint32_t synth_release_mask = 0;
+static uint8_t synth_id_voice[256]; //!< Voice index + 1 sounding each note id, 0 if none
+static uint32_t synth_note_count = 0;
+static volatile SynthWaveform synth_waveform = SYNTH_WAVE_SQUARE;
+static EnvelopeParams synth_env_params;
+
+static const int16_t *const synth_wave_tables[SYNTH_WAVE_COUNT] = {
+    [SYNTH_WAVE_SQUARE] = NULL,
+    [SYNTH_WAVE_SINE] = wavetable_sine,
+    [SYNTH_WAVE_TRIANGLE] = wavetable_triangle,
+    [SYNTH_WAVE_SAW] = wavetable_saw,
+    [SYNTH_WAVE_PIANO] = wavetable_piano,
+};
+
+/**
+ * @brief Oscillator output of a voice at a phase, scaled by an envelope gain.
+ */
+static inline int32_t synthVoiceSample(const int16_t *table, uint32_t phase, int32_t gain)
+{
+  if (table == NULL)
+    return (phase & 0x80000000u) ? -gain : gain;
+  return (wavetableSample(table, phase) * gain) >> 15;
+}
+
+void initSynth(void)
+{
+  synthAllNotesOff();
+  synthSetEnvelope(SYNTH_ATTACK_MS, SYNTH_DECAY_MS, SYNTH_SUSTAIN_PERCENT, SYNTH_RELEASE_MS);
+}
+
+void synthSetEnvelope(uint32_t attack_ms, uint32_t decay_ms, uint8_t sustain_percent,
+                      uint32_t release_ms)
+{
+  envelopeSetParams(&synth_env_params, SYNTH_VOICE_LEVEL, attack_ms, decay_ms, sustain_percent,
+                    release_ms, SYNTH_SAMPLE_RATE);
+}
+
+void synthSetWaveform(SynthWaveform waveform)
+{
+  if (waveform < SYNTH_WAVE_COUNT)
+    synth_waveform = waveform;
+}
+
+SynthWaveform synthWaveform(void)
+{
+  return synth_waveform;
+}
+
+/**
+ * @brief Returns a voice whose envelope has finished to the free pool.
+ */
+static inline void synthVoiceFree(uint8_t v)
+{
+  SynthVoice *voice = &synth_voices[v];
+  if (synth_id_voice[voice->id] == v + 1)
+    synth_id_voice[voice->id] = 0;
+  voice->gate = false;
+  synth_free_mask |= 1u << v;
+  synth_release_mask &= ~(1u << v);
+}
+
+/**
+ * @brief Picks a voice to steal when none is free: the quietest released
+ * voice, or else the oldest held one.
+ */
+static uint8_t HOT_PATH_FUNC(synthStealVoice)(void)
+{
+  uint32_t candidates = synth_release_mask ? synth_release_mask : SYNTH_ALL_VOICES;
+  uint8_t victim = (uint8_t)__builtin_ctz(candidates);
+  candidates &= candidates - 1;
+
+  while (candidates)
+  {
+    uint8_t v = (uint8_t)__builtin_ctz(candidates);
+    candidates &= candidates - 1;
+    if (synth_release_mask)
+    {
+      if (synth_voices[v].env.level < synth_voices[victim].env.level)
+        victim = v;
+    }
+    else if ((int32_t)(synth_voices[v].age - synth_voices[victim].age) < 0)
+    {
+      victim = v;
+    }
+  }
+  return victim;
+}
+
+/**
+ * @brief Picks the voice for a new note: the one already sounding its id, a
+ * free one, or a victim.
+ */
+static uint8_t HOT_PATH_FUNC(synthFindVoice)(uint8_t id)
+{
+  if (synth_id_voice[id])
+    return (uint8_t)(synth_id_voice[id] - 1);
+  if (synth_free_mask)
+    return (uint8_t)__builtin_ctz(synth_free_mask);
+  return synthStealVoice();
+}
+
+void HOT_PATH_FUNC(synthNoteOn)(uint8_t id, uint32_t phase_inc, uint8_t velocity)
+{
+  uint8_t v = synthFindVoice(id);
+  SynthVoice *voice = &synth_voices[v];
+
+  // A voice that is still sounding keeps its phase and level (the attack
+  // starts from where it is), so retriggers and steals don't click.
+  if (synth_free_mask & (1u << v))
+    voice->phase = 0;
+  else if (synth_id_voice[voice->id] == v + 1)
+    synth_id_voice[voice->id] = 0; // Stolen from another note
+  synth_id_voice[id] = (uint8_t)(v + 1);
+  synth_free_mask &= ~(1u << v);
+  synth_release_mask &= ~(1u << v);
+
+  voice->id = id;
+  voice->gate = true;
+  voice->age = ++synth_note_count;
+  voice->phase_inc = phase_inc;
+  voice->table = synth_wave_tables[synth_waveform];
+  envelopeScaleParams(&voice->params, &synth_env_params, (uint32_t)(velocity & 0x7F) + 1);
+  envelopeGateOn(&voice->env, &voice->params);
+  if (!envelopeActive(&voice->env))
+    synthVoiceFree(v);
+}
+
+void HOT_PATH_FUNC(synthNoteOff)(uint8_t id)
+{
+  uint8_t slot = synth_id_voice[id];
+  if (slot == 0 || !synth_voices[slot - 1].gate)
+    return;
+
+  uint8_t v = (uint8_t)(slot - 1);
+  SynthVoice *voice = &synth_voices[v];
+  voice->gate = false;
+  synth_release_mask |= 1u << v;
+  envelopeGateOff(&voice->env, &voice->params);
+  if (!envelopeActive(&voice->env))
+    synthVoiceFree(v);
+}
+
+void synthAllNotesOff(void)
+{
+  for (uint8_t v = 0; v < SYNTH_MAX_VOICES; v++)
+  {
+    envelopeReset(&synth_voices[v].env);
+    synth_voices[v].gate = false;
+  }
+  memset(synth_id_voice, 0, sizeof(synth_id_voice));
+  synth_free_mask = SYNTH_ALL_VOICES;
+  synth_release_mask = 0;
+}
+
+uint8_t synthActiveVoices(void)
+{
+  return (uint8_t)__builtin_popcount(~synth_free_mask & SYNTH_ALL_VOICES);
+}
+
+int16_t HOT_PATH_FUNC(synthRenderSample)(void)
+{
+  int32_t mix = 0;
+  uint32_t active = ~synth_free_mask & SYNTH_ALL_VOICES;
+
+  while (active)
+  {
+    uint8_t v = (uint8_t)__builtin_ctz(active);
+    active &= active - 1;
+    SynthVoice *voice = &synth_voices[v];
+
+    voice->phase += voice->phase_inc;
+    mix += synthVoiceSample(voice->table, voice->phase, (int32_t)(voice->env.level >> 16));
+    voice->env.level += (uint32_t)voice->env.step;
+    envelopeAdvance(&voice->env, &voice->params, 1);
+    if (!envelopeActive(&voice->env))
+      synthVoiceFree(v);
+  }
+  return (int16_t)mix;
+}
+
+#if SYNTH_USE_INTERP
+#define SYNTH_INTERP(n) ((n) ? interp1 : interp0)
+#endif
+
+/**
+ * @brief Working copy of a voice's oscillator over one envelope segment.
+ */
+typedef struct
+{
+  uint32_t phase;
+  uint32_t phase_inc;
+  uint32_t level;
+  uint32_t step;
+} SynthOsc;
+
+/**
+ * @brief Next output sample of an oscillator: advances its phase and level.
+ *
+ * A NULL table is a square wave, where the accumulator's top bit selects the
+ * half cycle. Always inlined so each caller's table test and interpolator
+ * number fold away.
+ * @param table Wavetable, or NULL for a square wave
+ * @param interp Interpolator holding the phase (see synthInterpLoad())
+ * @param osc Oscillator
+ */
+static inline __attribute__((always_inline)) int32_t synthOscillator(const int16_t *table,
+                                                                     uint8_t interp, SynthOsc *osc)
+{
+  int32_t gain = (int32_t)(osc->level >> 16);
+  int32_t sample;
+  osc->level += osc->step;
+#if SYNTH_USE_INTERP
+  if (table != NULL)
+  {
+    // Lane 0 holds the phase (accumulating phase_inc on each pop) and lane 1
+    // turns it into the address of the current table entry.
+    osc->phase = SYNTH_INTERP(interp)->pop[0];
+    const int16_t *entry = (const int16_t *)(uintptr_t)SYNTH_INTERP(interp)->peek[1];
+#if WAVETABLE_INTERPOLATE
+    int32_t a = entry[0];
+    int32_t frac = (int32_t)((osc->phase >> (17 - WAVETABLE_BITS)) & 0x7FFF);
+    sample = a + (((entry[1] - a) * frac) >> 15); // Guard entry: no wrap needed
+#else
+    sample = entry[0];
+#endif
+    return (sample * gain) >> 15;
+  }
+#else
+  (void)interp;
+#endif
+  osc->phase += osc->phase_inc;
+  if (table == NULL)
+    return (osc->phase & 0x80000000u) ? -gain : gain;
+  sample = wavetableSample(table, osc->phase);
+  return (sample * gain) >> 15;
+}
+
+/**
+ * @brief Starts a voice's oscillator: copies its phase, and with
+ * SYNTH_USE_INTERP hands a wavetable voice's phase to an interpolator.
+ *
+ * The phase lives in the interpolator until the render ends and
+ * synthOscillator() has copied its last value back to osc->phase.
+ */
+static inline void synthOscLoad(SynthOsc *osc, const SynthVoice *voice, uint8_t interp)
+{
+  osc->phase = voice->phase;
+  osc->phase_inc = voice->phase_inc;
+#if SYNTH_USE_INTERP
+  if (voice->table != NULL)
+  {
+    SYNTH_INTERP(interp)->accum[0] = voice->phase;
+    SYNTH_INTERP(interp)->base[0] = voice->phase_inc;
+    SYNTH_INTERP(interp)->base[1] = (uintptr_t)voice->table;
+  }
+#else
+  (void)interp;
+#endif
+}
+
+/**
+ * @brief Adds an oscillator over one envelope segment, two samples per word.
+ *
+ * A sample before and after the aligned middle are added on their own.
+ */
+static inline __attribute__((always_inline)) void synthMixSegment(const int16_t *table, int16_t *out,
+                                                                  uint32_t count, SynthOsc *osc)
+{
+  if (count > 0 && ((uintptr_t)out & 2))
+  {
+    *out = (int16_t)(*out + synthOscillator(table, 0, osc));
+    out++;
+    count--;
+  }
+
+  // Voice levels are scaled so the sum always fits, so the halves may wrap.
+  MixerPair *pair = (MixerPair *)out;
+  for (uint32_t i = count / 2; i > 0; i--)
+  {
+    int32_t first = synthOscillator(table, 0, osc);
+    int32_t second = synthOscillator(table, 0, osc);
+    *pair = mixerAdd2(*pair, mixerPack2(first, second));
+    pair++;
+  }
+
+  if (count & 1)
+  {
+    out += count - 1;
+    *out = (int16_t)(*out + synthOscillator(table, 0, osc));
+  }
+}
+
+/**
+ * @brief Adds two oscillators over a segment both envelopes share, with one
+ * read and write of the block for every four oscillator steps.
+ *
+ * Wavetable voices run on interp0 and interp1 side by side.
+ */
+static inline __attribute__((always_inline)) void synthMixPairSegment(const int16_t *table_a,
+                                                                      const int16_t *table_b,
+                                                                      int16_t *out, uint32_t count,
+                                                                      SynthOsc *a, SynthOsc *b)
+{
+  if (count > 0 && ((uintptr_t)out & 2))
+  {
+    *out = (int16_t)(*out + synthOscillator(table_a, 0, a) + synthOscillator(table_b, 1, b));
+    out++;
+    count--;
+  }
+
+  MixerPair *pair = (MixerPair *)out;
+  for (uint32_t i = count / 2; i > 0; i--)
+  {
+    int32_t first = synthOscillator(table_a, 0, a);
+    first += synthOscillator(table_b, 1, b);
+    int32_t second = synthOscillator(table_a, 0, a);
+    second += synthOscillator(table_b, 1, b);
+    *pair = mixerAdd2(*pair, mixerPack2(first, second));
+    pair++;
+  }
+
+  if (count & 1)
+  {
+    out += count - 1;
+    *out = (int16_t)(*out + synthOscillator(table_a, 0, a) + synthOscillator(table_b, 1, b));
+  }
+}
+
+/**
+ * @brief Adds one voice over count samples, one envelope segment at a time.
+ */
+static void HOT_PATH_FUNC(synthRenderVoice)(SynthVoice *voice, int16_t *out, uint32_t count)
+{
+  SynthOsc osc;
+  synthOscLoad(&osc, voice, 0);
+
+  while (count > 0 && envelopeActive(&voice->env))
+  {
+    uint32_t segment = envelopeSegment(&voice->env, count);
+    osc.level = voice->env.level;
+    osc.step = (uint32_t)voice->env.step;
+
+    if (voice->table == NULL)
+      synthMixSegment(NULL, out, segment, &osc);
+    else
+      synthMixSegment(voice->table, out, segment, &osc);
+
+    voice->env.level = osc.level;
+    envelopeAdvance(&voice->env, &voice->params, segment);
+    out += segment;
+    count -= segment;
+  }
+  voice->phase = osc.phase;
+}
+
+/**
+ * @brief Adds two voices of the same kind (both square or both wavetable)
+ * over count samples, in segments where neither envelope changes stage.
+ *
+ * Once one of them ends, the other finishes the block on its own.
+ */
+static void HOT_PATH_FUNC(synthRenderPair)(SynthVoice *voice_a, SynthVoice *voice_b, int16_t *out,
+                                           uint32_t count)
+{
+  SynthOsc a;
+  SynthOsc b;
+  synthOscLoad(&a, voice_a, 0);
+  synthOscLoad(&b, voice_b, 1);
+
+  while (count > 0 && envelopeActive(&voice_a->env) && envelopeActive(&voice_b->env))
+  {
+    uint32_t segment = envelopeSegment(&voice_a->env, envelopeSegment(&voice_b->env, count));
+    a.level = voice_a->env.level;
+    a.step = (uint32_t)voice_a->env.step;
+    b.level = voice_b->env.level;
+    b.step = (uint32_t)voice_b->env.step;
+
+    if (voice_a->table == NULL)
+      synthMixPairSegment(NULL, NULL, out, segment, &a, &b);
+    else
+      synthMixPairSegment(voice_a->table, voice_b->table, out, segment, &a, &b);
+
+    voice_a->env.level = a.level;
+    envelopeAdvance(&voice_a->env, &voice_a->params, segment);
+    voice_b->env.level = b.level;
+    envelopeAdvance(&voice_b->env, &voice_b->params, segment);
+    out += segment;
+    count -= segment;
+  }
+  voice_a->phase = a.phase;
+  voice_b->phase = b.phase;
+
+  if (count > 0)
+    synthRenderVoice(envelopeActive(&voice_a->env) ? voice_a : voice_b, out, count);
+}
+
+#if SYNTH_USE_INTERP
+/**
+ * @brief Sets up interp0 and interp1 of the calling core as wavetable
+ * oscillators.
+ *
+ * Lane 0 adds BASE0 (the phase increment) to the phase on every pop; lane 1
+ * reads the same accumulator and returns BASE1 (the table) plus the index in
+ * bytes. Cheap enough to redo every block, which keeps it right whichever
+ * core renders.
+ */
+static inline void synthInitInterp(interp_hw_t *interp)
+{
+  interp_config config = interp_default_config();
+  interp_config_set_add_raw(&config, true);
+  interp_set_config(interp, 0, &config);
+
+  config = interp_default_config();
+  interp_config_set_cross_input(&config, true);
+  interp_config_set_shift(&config, 32 - WAVETABLE_BITS - 1);
+  interp_config_set_mask(&config, 1, WAVETABLE_BITS);
+  interp_set_config(interp, 1, &config);
+}
+#endif
+
+/**
+ * @brief Finds an active voice that can share synthRenderPair() with voice.
+ * @param candidates Active voices not rendered yet
+ * @return Its index, or SYNTH_MAX_VOICES if there is none
+ */
+static inline uint8_t synthFindPartner(const SynthVoice *voice, uint32_t candidates)
+{
+  while (candidates)
+  {
+    uint8_t v = (uint8_t)__builtin_ctz(candidates);
+    candidates &= candidates - 1;
+    if ((synth_voices[v].table == NULL) == (voice->table == NULL))
+      return v;
+  }
+  return SYNTH_MAX_VOICES;
+}
+
+void HOT_PATH_FUNC(synthRenderBlock)(int16_t *out, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    out[i] = 0;
+
+#if SYNTH_USE_INTERP
+#if SYNTH_INTERP_SAVE
+  interp_hw_save_t saved[2];
+  interp_save(interp0, &saved[0]);
+  interp_save(interp1, &saved[1]);
+#endif
+  synthInitInterp(interp0);
+  synthInitInterp(interp1);
+#endif
+
+  // Voice levels are scaled so the sum always fits, with no clipping needed.
+  // Voices are rendered two at a time where possible.
+  uint32_t active = ~synth_free_mask & SYNTH_ALL_VOICES;
+  while (active)
+  {
+    uint8_t v = (uint8_t)__builtin_ctz(active);
+    active &= active - 1;
+    uint8_t w = synthFindPartner(&synth_voices[v], active);
+
+    if (w < SYNTH_MAX_VOICES)
+    {
+      active &= ~(1u << w);
+      synthRenderPair(&synth_voices[v], &synth_voices[w], out, count);
+      if (!envelopeActive(&synth_voices[w].env))
+        synthVoiceFree(w);
+    }
+    else
+    {
+      synthRenderVoice(&synth_voices[v], out, count);
+    }
+    if (!envelopeActive(&synth_voices[v].env))
+      synthVoiceFree(v);
+  }
+
+#if SYNTH_USE_INTERP && SYNTH_INTERP_SAVE
+  interp_restore(interp0, &saved[0]);
+  interp_restore(interp1, &saved[1]);
+#endif
+}
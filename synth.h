@@ -0,0 +1,161 @@
+/**
+ * @file synth.h
+ * @brief Polyphonic software synthesizer.
+ *
+ * Up to SYNTH_MAX_VOICES notes sound at once. Each voice is a 32-bit
+ * fixed-point phase accumulator driving either a square wave or a wavetable
+ * (wavetable.h), shaped by an ADSR envelope (envelope.h) that follows the key;
+ * voices are summed into one signed 16-bit output. The render path uses
+ * integer arithmetic only.
+ */
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of simultaneous voices (1-8).
+ */
+#ifndef SYNTH_MAX_VOICES
+#define SYNTH_MAX_VOICES 4
+#endif
+
+/**
+ * @brief Output sample rate in Hz.
+ */
+#ifndef SYNTH_SAMPLE_RATE
+#define SYNTH_SAMPLE_RATE 25000
+#endif
+
+/**
+ * @brief Default envelope (see synthSetEnvelope()).
+ */
+#ifndef SYNTH_ATTACK_MS
+#define SYNTH_ATTACK_MS 5
+#endif
+#ifndef SYNTH_DECAY_MS
+#define SYNTH_DECAY_MS 150
+#endif
+#ifndef SYNTH_SUSTAIN_PERCENT
+#define SYNTH_SUSTAIN_PERCENT 60
+#endif
+#ifndef SYNTH_RELEASE_MS
+#define SYNTH_RELEASE_MS 120
+#endif
+
+/**
+ * @brief 1 to step wavetable voices with the RP2040 interpolators.
+ *
+ * Uses interp0 and interp1 of the core that renders; ignored off target.
+ */
+#ifndef SYNTH_USE_INTERP
+#define SYNTH_USE_INTERP 1
+#endif
+
+/**
+ * @brief 1 to save the interpolators on entry to synthRenderBlock() and
+ * restore them on exit.
+ *
+ * Needed when rendering can interrupt other code using them (single-core
+ * builds render in the audio DMA IRQ); 0 saves about 30 register accesses
+ * per block.
+ */
+#ifndef SYNTH_INTERP_SAVE
+#define SYNTH_INTERP_SAVE 1
+#endif
+
+#if SYNTH_MAX_VOICES < 1 || SYNTH_MAX_VOICES > 8
+#error "SYNTH_MAX_VOICES must be between 1 and 8"
+#endif
+
+/**
+ * @brief Oscillator waveforms.
+ */
+typedef enum
+{
+  SYNTH_WAVE_SQUARE,
+  SYNTH_WAVE_SINE,
+  SYNTH_WAVE_TRIANGLE,
+  SYNTH_WAVE_SAW,
+  SYNTH_WAVE_PIANO,
+  SYNTH_WAVE_COUNT
+} SynthWaveform;
+
+/**
+ * @brief Silences all voices and loads the default envelope.
+ */
+void initSynth(void);
+
+/**
+ * @brief Sets the ADSR envelope of every voice.
+ * @param attack_ms Time from silence to peak
+ * @param decay_ms Time from peak to sustain
+ * @param sustain_percent Level held while the key is down, percent of peak
+ * @param release_ms Time from peak to silence after the key is released
+ */
+void synthSetEnvelope(uint32_t attack_ms, uint32_t decay_ms, uint8_t sustain_percent,
+                      uint32_t release_ms);
+
+/**
+ * @brief Selects the waveform used by notes started from now on.
+ *
+ * A single word store, so it may be called from either core.
+ */
+void synthSetWaveform(SynthWaveform waveform);
+
+/**
+ * @brief The waveform used for new notes.
+ */
+SynthWaveform synthWaveform(void);
+
+/**
+ * @brief Starts a note on a free voice (or steals one if all are busy).
+ *
+ * Starting an id that is already sounding retriggers its voice. With every
+ * voice busy, the quietest released voice is taken, or the oldest held one
+ * if no key has been released; the stolen voice glides from its current level.
+ * @param id Caller-chosen note identifier (e.g. key index)
+ * @param phase_inc Phase increment per sample, freq * 2^32 / SYNTH_SAMPLE_RATE
+ * (see NoteEntry in notes.h)
+ * @param velocity MIDI velocity 1..127, scaling the envelope levels linearly
+ */
+void synthNoteOn(uint8_t id, uint32_t phase_inc, uint8_t velocity);
+
+/**
+ * @brief Releases the voice playing the given note id, if any.
+ *
+ * The voice fades out over the release time and is then freed.
+ * @param id Identifier passed to synthNoteOn()
+ */
+void synthNoteOff(uint8_t id);
+
+/**
+ * @brief Silences every voice immediately.
+ */
+void synthAllNotesOff(void);
+
+/**
+ * @brief Number of voices currently sounding.
+ */
+uint8_t synthActiveVoices(void);
+
+/**
+ * @brief Advances all voices by one sample and mixes them.
+ * @return Mixed signed 16-bit sample
+ */
+int16_t synthRenderSample(void);
+
+/**
+ * @brief Renders a block of mixed samples.
+ *
+ * Produces the same output as calling synthRenderSample() count times, but
+ * runs voice by voice (two voices at a time where both are square or both
+ * wavetable) over the block for a tighter inner loop that adds two samples
+ * per 32-bit word (mixer.h).
+ * @param out Receives count samples
+ * @param count Number of samples to render
+ */
+void synthRenderBlock(int16_t *out, uint32_t count);
+
+#endif // SYNTH_H
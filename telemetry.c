@@ -0,0 +1,115 @@
+/**
+ * @file telemetry.c
+ * @brief Operational counters and per-core load, dumped over USB stdio.
+ */
+#include "telemetry.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "audio.h"
+#include "audio_out.h"
+#include "usb_midi.h"
+
+volatile uint32_t telemetry_counters[TELEMETRY_COUNTER_COUNT];
+volatile uint32_t telemetry_idle_us[2];
+
+/**
+ * @brief Every total at one instant.
+ */
+typedef struct
+{
+  uint32_t time_us;
+  uint32_t counters[TELEMETRY_COUNTER_COUNT];
+  uint32_t idle_us[2];
+  uint32_t audio_dropped;
+  uint32_t midi_dropped;
+} TelemetrySnapshot;
+
+// Both start out as the all-zero totals at boot.
+static TelemetrySnapshot telemetry_reset_point; //!< Totals at the last reset
+static TelemetrySnapshot telemetry_last_dump;   //!< Totals at the previous dump
+
+static const char *const telemetry_counter_names[TELEMETRY_COUNTER_COUNT] = {
+    "scans",
+    "key presses",
+    "key releases",
+    "audio blocks",
+    "audio underruns",
+};
+
+static void telemetrySnapshot(TelemetrySnapshot *snapshot)
+{
+  snapshot->time_us = time_us_32();
+  for (int c = 0; c < TELEMETRY_COUNTER_COUNT; c++)
+    snapshot->counters[c] = telemetry_counters[c];
+  snapshot->idle_us[0] = telemetry_idle_us[0];
+  snapshot->idle_us[1] = telemetry_idle_us[1];
+#if PIANO_POLYPHONIC
+  snapshot->audio_dropped = audioDroppedEvents();
+#else
+  snapshot->audio_dropped = 0;
+#endif
+#if PIANO_USB_MIDI
+  snapshot->midi_dropped = usbMidiDroppedEvents();
+#else
+  snapshot->midi_dropped = 0;
+#endif
+}
+
+/**
+ * @brief Busy share of a core between two snapshots, in tenths of a percent.
+ */
+static uint32_t telemetryLoad(const TelemetrySnapshot *from, const TelemetrySnapshot *to, int core)
+{
+  uint32_t elapsed = to->time_us - from->time_us;
+  uint32_t idle = to->idle_us[core] - from->idle_us[core];
+  if (elapsed == 0)
+    return 0;
+  if (idle > elapsed)
+    idle = elapsed; // An idle period straddling a snapshot
+  return (uint32_t)(((uint64_t)(elapsed - idle) * 1000) / elapsed);
+}
+
+void telemetryDump(void)
+{
+  TelemetrySnapshot now;
+  telemetrySnapshot(&now);
+  const TelemetrySnapshot *window = &telemetry_last_dump;
+  uint32_t window_ms = (now.time_us - window->time_us) / 1000;
+
+  printf("since reset %lu s, rates over the last %lu ms\n",
+         (unsigned long)((now.time_us - telemetry_reset_point.time_us) / 1000000),
+         (unsigned long)window_ms);
+  for (int c = 0; c < TELEMETRY_COUNTER_COUNT; c++)
+  {
+    uint32_t delta = now.counters[c] - window->counters[c];
+    printf("%-16s %10lu %8lu/s\n", telemetry_counter_names[c],
+           (unsigned long)(now.counters[c] - telemetry_reset_point.counters[c]),
+           (unsigned long)(window_ms ? (uint64_t)delta * 1000 / window_ms : 0));
+  }
+  printf("%-16s %10lu\n", "queue overflows",
+         (unsigned long)(now.audio_dropped - telemetry_reset_point.audio_dropped));
+  printf("%-16s %10lu\n", "midi overflows",
+         (unsigned long)(now.midi_dropped - telemetry_reset_point.midi_dropped));
+
+#if PIANO_POLYPHONIC
+  printf("%-16s %10lu blocks\n", "audio depth", (unsigned long)audioOutDepth());
+#endif
+
+  uint32_t load0 = telemetryLoad(window, &now, 0);
+  uint32_t load1 = telemetryLoad(window, &now, 1);
+  printf("core 0 busy %lu.%lu%%", (unsigned long)(load0 / 10), (unsigned long)(load0 % 10));
+#if PIANO_POLYPHONIC && AUDIO_DUAL_CORE
+  printf(", core 1 busy %lu.%lu%%\n", (unsigned long)(load1 / 10), (unsigned long)(load1 % 10));
+#else
+  (void)load1;
+  printf("\n");
+#endif
+
+  telemetry_last_dump = now;
+}
+
+void telemetryReset(void)
+{
+  telemetrySnapshot(&telemetry_reset_point);
+  telemetry_last_dump = telemetry_reset_point;
+}
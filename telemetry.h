@@ -0,0 +1,74 @@
+/**
+ * @file telemetry.h
+ * @brief Operational counters and per-core load, dumped over USB stdio.
+ *
+ * Counters are 32-bit words with a single writer each (the core noted per
+ * counter), so increments need no lock and readers on either core never see
+ * a torn value. Resets only move a baseline the dump subtracts, so no core
+ * ever writes another core's counter.
+ *
+ * Core load comes from idle accounting: each core adds the time it spends
+ * waiting (sleep, __wfi) to its idle total, and the dump reports the busy
+ * share of the time since the previous dump. Interrupts taken during core 0's
+ * sleeps count as idle; core 1 masks them while it waits, so its audio IRQ
+ * time counts as busy.
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+/**
+ * @brief Counted events.
+ */
+typedef enum
+{
+  TELEMETRY_SCANS,           //!< Keypad scans (core 0)
+  TELEMETRY_KEY_PRESSES,     //!< Debounced key presses (core 0)
+  TELEMETRY_KEY_RELEASES,    //!< Debounced key releases (core 0)
+  TELEMETRY_AUDIO_BLOCKS,    //!< Audio blocks rendered (audio core)
+  TELEMETRY_AUDIO_UNDERRUNS, //!< Blocks faded out because none was rendered in time (audio core)
+  TELEMETRY_COUNTER_COUNT
+} TelemetryCounter;
+
+extern volatile uint32_t telemetry_counters[TELEMETRY_COUNTER_COUNT];
+extern volatile uint32_t telemetry_idle_us[2];
+
+/**
+ * @brief Adds to a counter. Only call from the counter's own core.
+ */
+static inline void telemetryAdd(TelemetryCounter counter, uint32_t n)
+{
+  telemetry_counters[counter] += n;
+}
+
+/**
+ * @brief Counts one event. Only call from the counter's own core.
+ */
+static inline void telemetryCount(TelemetryCounter counter)
+{
+  telemetryAdd(counter, 1);
+}
+
+/**
+ * @brief Accounts time the calling core spent idle.
+ * @param core Calling core (get_core_num())
+ * @param us Idle time in us
+ */
+static inline void telemetryIdle(unsigned core, uint32_t us)
+{
+  telemetry_idle_us[core & 1] += us;
+}
+
+/**
+ * @brief Console command: prints totals since the last reset, and rates and
+ * core load since the previous dump (which must be under ~70 minutes ago).
+ */
+void telemetryDump(void);
+
+/**
+ * @brief Console command: restarts all totals from zero.
+ */
+void telemetryReset(void);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,124 @@
+/**
+ * @file tone.c
+ * @brief Non-blocking square-wave tone engine for the buzzer.
+ */
+#include "tone.h"
+#include "notes.h"
+#include "scheduler.h"
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+
+static uint tone_slice;
+static uint tone_channel;
+static volatile bool tone_playing = false;
+static volatile SchedulerId tone_event = 0;
+static absolute_time_t tone_end;
+
+/**
+ * @brief Scheduler callback that ends a timed note (runs in IRQ context).
+ */
+static uint32_t toneEndCallback(void *user_data)
+{
+  (void)user_data;
+  pwm_set_chan_level(tone_slice, tone_channel, 0);
+  tone_playing = false;
+  tone_event = 0;
+  return 0; // Do not reschedule
+}
+
+/**
+ * @brief Cancels the pending note-off, if any.
+ */
+static void toneCancelEnd(void)
+{
+  if (tone_event > 0)
+  {
+    schedulerCancel(tone_event);
+    tone_event = 0;
+  }
+}
+
+void initToneEngine(void)
+{
+  gpio_set_function(TONE_PIN, GPIO_FUNC_PWM);
+  tone_slice = pwm_gpio_to_slice_num(TONE_PIN);
+  tone_channel = pwm_gpio_to_channel(TONE_PIN);
+
+  pwm_config config = pwm_get_default_config();
+  pwm_init(tone_slice, &config, true);
+  pwm_set_chan_level(tone_slice, tone_channel, 0);
+}
+
+/**
+ * @brief Loads a PWM divider/wrap pair and schedules the note-off.
+ */
+static void tonePlay(uint32_t div16, uint32_t top, uint32_t duration_ms)
+{
+  pwm_set_clkdiv_int_frac(tone_slice, div16 >> 4, div16 & 0xF);
+  pwm_set_wrap(tone_slice, top);
+  pwm_set_chan_level(tone_slice, tone_channel, top / 2); // 50% duty square wave
+  tone_playing = true;
+
+  if (duration_ms > 0)
+  {
+    tone_end = make_timeout_time_ms(duration_ms);
+    tone_event = schedulerAt(tone_end, toneEndCallback, NULL);
+  }
+}
+
+void toneStart(uint freq_hz, uint32_t duration_ms)
+{
+  toneCancelEnd();
+
+  if (freq_hz == 0)
+  {
+    toneStop();
+    return;
+  }
+
+  // Pick the smallest 8.4 fixed-point divider that keeps wrap within 16 bits,
+  // which gives the finest frequency resolution for this note.
+  uint32_t clock = clock_get_hz(clk_sys);
+  uint32_t div16 = (uint32_t)(((uint64_t)clock * 16 + (uint64_t)freq_hz * 65536 - 1) /
+                              ((uint64_t)freq_hz * 65536));
+  if (div16 < 16)
+    div16 = 16;
+  if (div16 > 0xFFF)
+    div16 = 0xFFF;
+  uint32_t top = (uint32_t)(((uint64_t)clock * 16) / ((uint64_t)div16 * freq_hz)) - 1;
+  if (top > 0xFFFF)
+    top = 0xFFFF;
+
+  tonePlay(div16, top, duration_ms);
+}
+
+void toneStartNote(uint8_t midi_note, uint32_t duration_ms)
+{
+  toneCancelEnd();
+
+  // The table assumes the clk_sys it was generated for.
+  const NoteEntry *entry = noteEntry(midi_note);
+  tonePlay(entry->pwm_div16, entry->pwm_top, duration_ms);
+}
+
+void toneStop(void)
+{
+  toneCancelEnd();
+  pwm_set_chan_level(tone_slice, tone_channel, 0);
+  tone_playing = false;
+}
+
+bool toneIsPlaying(void)
+{
+  return tone_playing;
+}
+
+uint32_t toneRemainingMs(void)
+{
+  if (!tone_playing || tone_event <= 0)
+    return 0;
+
+  int64_t remaining_us = absolute_time_diff_us(get_absolute_time(), tone_end);
+  return remaining_us > 0 ? (uint32_t)(remaining_us / 1000) : 0;
+}
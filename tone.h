@@ -0,0 +1,65 @@
+/**
+ * @file tone.h
+ * @brief Non-blocking square-wave tone engine for the buzzer.
+ *
+ * Unlike playTone(), which sleeps for the whole note, toneStart() programs the
+ * buzzer PWM and returns immediately. A scheduler event (scheduler.h)
+ * silences the buzzer when the requested duration elapses, so the caller
+ * keeps scanning the keypad while the note sounds.
+ */
+#ifndef TONE_H
+#define TONE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+/**
+ * @brief GPIO driving the buzzer (BitDogLab buzzer A).
+ */
+#ifndef TONE_PIN
+#define TONE_PIN 21
+#endif
+
+/**
+ * @brief Takes over the buzzer PWM slice for the tone engine.
+ *
+ * Call after initBuzzerPWM()/playWelcomeTones() if those are still used, as
+ * this reconfigures the slice for variable-frequency output.
+ */
+void initToneEngine(void);
+
+/**
+ * @brief Starts a note and returns immediately.
+ *
+ * A note already sounding is replaced without a gap.
+ * @param freq_hz Note frequency in Hz (0 silences the buzzer)
+ * @param duration_ms Note length in ms, or 0 to sound until toneStop()
+ */
+void toneStart(uint freq_hz, uint32_t duration_ms);
+
+/**
+ * @brief Starts a MIDI note from the precomputed note table (no divisions).
+ * @param midi_note MIDI note number, played in the active tuning (notes.h)
+ * @param duration_ms Note length in ms, or 0 to sound until toneStop()
+ */
+void toneStartNote(uint8_t midi_note, uint32_t duration_ms);
+
+/**
+ * @brief Silences the buzzer and cancels any pending note-off.
+ */
+void toneStop(void);
+
+/**
+ * @brief Checks whether a note is currently sounding.
+ * @return true while the buzzer is producing a tone
+ */
+bool toneIsPlaying(void);
+
+/**
+ * @brief Time left before the current note stops by itself.
+ * @return Remaining duration in ms, 0 if idle or the note is untimed
+ */
+uint32_t toneRemainingMs(void);
+
+#endif // TONE_H
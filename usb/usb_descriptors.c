@@ -0,0 +1,118 @@
+/**
+ * @file usb_descriptors.c
+ * @brief USB descriptors of the composite device: CDC console + USB-MIDI.
+ */
+#include <string.h>
+#include "tusb.h"
+#include "usb_device.h"
+#include "pico/unique_id.h"
+
+enum
+{
+  USB_ITF_CDC = 0,
+  USB_ITF_CDC_DATA,
+  USB_ITF_MIDI,
+  USB_ITF_MIDI_STREAMING,
+  USB_ITF_COUNT
+};
+
+enum
+{
+  USB_STR_LANGUAGE = 0,
+  USB_STR_MANUFACTURER,
+  USB_STR_PRODUCT,
+  USB_STR_SERIAL,
+  USB_STR_CDC,
+  USB_STR_MIDI,
+  USB_STR_COUNT
+};
+
+#define USB_EP_CDC_NOTIFY 0x81
+#define USB_EP_CDC_OUT 0x02
+#define USB_EP_CDC_IN 0x82
+#define USB_EP_MIDI_OUT 0x03
+#define USB_EP_MIDI_IN 0x83
+
+#define USB_CONFIG_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MIDI_DESC_LEN)
+
+static const tusb_desc_device_t usb_device_descriptor = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // CDC needs an interface association, announced through the misc class.
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_DEVICE_VID,
+    .idProduct = USB_DEVICE_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = USB_STR_MANUFACTURER,
+    .iProduct = USB_STR_PRODUCT,
+    .iSerialNumber = USB_STR_SERIAL,
+    .bNumConfigurations = 1,
+};
+
+static const uint8_t usb_config_descriptor[] = {
+    TUD_CONFIG_DESCRIPTOR(1, USB_ITF_COUNT, 0, USB_CONFIG_LEN, 0, 100),
+    TUD_CDC_DESCRIPTOR(USB_ITF_CDC, USB_STR_CDC, USB_EP_CDC_NOTIFY, 8, USB_EP_CDC_OUT,
+                       USB_EP_CDC_IN, 64),
+    TUD_MIDI_DESCRIPTOR(USB_ITF_MIDI, USB_STR_MIDI, USB_EP_MIDI_OUT, USB_EP_MIDI_IN, 64),
+};
+
+static const char *const usb_strings[USB_STR_COUNT] = {
+    [USB_STR_MANUFACTURER] = "BitDogLab",
+    [USB_STR_PRODUCT] = "BitDog Keyboard Piano",
+    [USB_STR_CDC] = "Piano Console",
+    [USB_STR_MIDI] = "Piano MIDI",
+};
+
+uint8_t const *tud_descriptor_device_cb(void)
+{
+  return (uint8_t const *)&usb_device_descriptor;
+}
+
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
+{
+  (void)index;
+  return usb_config_descriptor;
+}
+
+uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
+{
+  static uint16_t descriptor[32];
+  (void)langid;
+
+  uint8_t len;
+  if (index == USB_STR_LANGUAGE)
+  {
+    descriptor[1] = 0x0409; // English (US)
+    len = 1;
+  }
+  else
+  {
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *str;
+    if (index == USB_STR_SERIAL)
+    {
+      pico_get_unique_board_id_string(serial, sizeof(serial));
+      str = serial;
+    }
+    else if (index < USB_STR_COUNT && usb_strings[index] != NULL)
+    {
+      str = usb_strings[index];
+    }
+    else
+    {
+      return NULL;
+    }
+
+    size_t length = strlen(str);
+    len = (uint8_t)(length < 31 ? length : 31);
+    for (uint8_t i = 0; i < len; i++)
+      descriptor[1 + i] = (uint8_t)str[i];
+  }
+
+  descriptor[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * len + 2));
+  return descriptor;
+}
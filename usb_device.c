@@ -0,0 +1,183 @@
+/**
+ * @file usb_device.c
+ * @brief TinyUSB composite device: CDC stdio console plus USB-MIDI.
+ */
+#include "usb_device.h"
+#include "tusb.h"
+#include "scheduler.h"
+#include "usb_midi.h"
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "pico/mutex.h"
+#include "pico/stdio/driver.h"
+#include "hardware/irq.h"
+
+// Line coding the host sets to request a reboot into BOOTSEL, as with the
+// SDK's USB stdio (picotool, IDE upload buttons).
+#define USB_RESET_BAUD 1200
+
+static mutex_t usb_mutex;
+static uint usb_task_irq;
+static SchedulerId usb_frame_timer = 0;
+static bool usb_frame_stopped = false;
+static void (*usb_chars_available)(void *) = NULL;
+static void *usb_chars_available_param = NULL;
+
+/**
+ * @brief Lowest-priority IRQ: services TinyUSB unless thread code holds it.
+ */
+static void usbTaskIrq(void)
+{
+  if (mutex_try_enter(&usb_mutex, NULL))
+  {
+    tud_task();
+    usbMidiTask();
+    mutex_exit(&usb_mutex);
+  }
+}
+
+/**
+ * @brief Once per USB frame: schedules the task IRQ.
+ */
+static uint32_t usbFrameTimerCallback(void *user_data)
+{
+  (void)user_data;
+  irq_set_pending(usb_task_irq);
+  return 1000;
+}
+
+/**
+ * @brief USB controller IRQ (shared with TinyUSB): runs the task right after
+ * TinyUSB queues an event, instead of at the next frame tick.
+ */
+static void usbControllerIrq(void)
+{
+  irq_set_pending(usb_task_irq);
+}
+
+/**
+ * @brief Takes the TinyUSB lock for stdio, or gives up.
+ *
+ * An IRQ handler may have preempted the USB task holding the lock on this
+ * core, which cannot release it before the handler returns, so handlers only
+ * try once. Thread code waits, bounded like the SDK's stdio_usb.
+ * @return true if the lock is held
+ */
+static bool usbStdioLock(void)
+{
+  if (__get_current_exception())
+    return mutex_try_enter(&usb_mutex, NULL);
+  return mutex_enter_timeout_us(&usb_mutex, USB_STDIO_LOCK_TIMEOUT_US);
+}
+
+static void usbStdioOutChars(const char *buf, int len)
+{
+  if (!usbStdioLock())
+    return;
+  uint64_t deadline = time_us_64() + USB_STDIO_WRITE_TIMEOUT_US;
+  int done = 0;
+  while (done < len && tud_cdc_connected())
+  {
+    uint32_t space = tud_cdc_write_available();
+    if (space == 0)
+    {
+      // The host is not reading: give up rather than stall the caller.
+      if (time_us_64() > deadline)
+        break;
+      tud_task();
+      continue;
+    }
+    uint32_t chunk = (uint32_t)(len - done) < space ? (uint32_t)(len - done) : space;
+    done += (int)tud_cdc_write(buf + done, chunk);
+    tud_cdc_write_flush();
+  }
+  mutex_exit(&usb_mutex);
+}
+
+static void usbStdioOutFlush(void)
+{
+  if (!usbStdioLock())
+    return;
+  tud_cdc_write_flush();
+  mutex_exit(&usb_mutex);
+}
+
+static int usbStdioInChars(char *buf, int len)
+{
+  int count = PICO_ERROR_NO_DATA;
+  if (!usbStdioLock())
+    return count;
+  if (tud_cdc_available())
+    count = (int)tud_cdc_read(buf, (uint32_t)len);
+  mutex_exit(&usb_mutex);
+  return count;
+}
+
+static void usbStdioSetCharsAvailableCallback(void (*fn)(void *), void *param)
+{
+  usb_chars_available = fn;
+  usb_chars_available_param = param;
+}
+
+static stdio_driver_t usb_stdio_driver = {
+    .out_chars = usbStdioOutChars,
+    .out_flush = usbStdioOutFlush,
+    .in_chars = usbStdioInChars,
+    .set_chars_available_callback = usbStdioSetCharsAvailableCallback,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+/**
+ * @brief TinyUSB callback (task IRQ): console input arrived.
+ */
+void tud_cdc_rx_cb(uint8_t itf)
+{
+  (void)itf;
+  if (usb_chars_available)
+    usb_chars_available(usb_chars_available_param);
+}
+
+/**
+ * @brief TinyUSB callback (task IRQ): the host changed the baud rate.
+ */
+void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const *line_coding)
+{
+  (void)itf;
+  if (line_coding->bit_rate == USB_RESET_BAUD)
+    reset_usb_boot(0, 0);
+}
+
+void initUsbDevice(void)
+{
+  mutex_init(&usb_mutex);
+  tusb_init();
+
+  usb_task_irq = (uint)user_irq_claim_unused(true);
+  irq_set_exclusive_handler(usb_task_irq, usbTaskIrq);
+  irq_set_priority(usb_task_irq, PICO_LOWEST_IRQ_PRIORITY);
+  irq_set_enabled(usb_task_irq, true);
+
+  irq_add_shared_handler(USBCTRL_IRQ, usbControllerIrq,
+                         PICO_SHARED_IRQ_HANDLER_LOWEST_ORDER_PRIORITY);
+  usb_frame_timer = schedulerIn(1000, usbFrameTimerCallback, NULL);
+
+  stdio_set_driver_enabled(&usb_stdio_driver, true);
+}
+
+void usbDeviceSleep(void)
+{
+  // Host traffic still raises USBCTRL_IRQ, which runs the task.
+  if (schedulerCancel(usb_frame_timer))
+    usb_frame_stopped = true;
+  usb_frame_timer = 0;
+}
+
+void usbDeviceWake(void)
+{
+  if (!usb_frame_stopped)
+    return;
+  usb_frame_stopped = false;
+  usb_frame_timer = schedulerIn(1000, usbFrameTimerCallback, NULL);
+}
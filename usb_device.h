@@ -0,0 +1,60 @@
+/**
+ * @file usb_device.h
+ * @brief TinyUSB composite device: CDC stdio console plus USB-MIDI.
+ *
+ * Replaces the SDK's USB stdio (pico_enable_stdio_usb) so that a USB-MIDI
+ * function can sit next to the console on the same port. TinyUSB is serviced
+ * every millisecond (one full-speed frame) and on every USB interrupt from a
+ * lowest-priority IRQ, which also runs the MIDI transfers (usb_midi.h).
+ * stdio calls from thread context share TinyUSB with it through a mutex.
+ * While the core is clocked down (power.h) the frame tick is stopped and only
+ * USB interrupts service TinyUSB.
+ */
+#ifndef USB_DEVICE_H
+#define USB_DEVICE_H
+
+/**
+ * @brief USB vendor and product id (the TinyUSB example ids; override for
+ * production boards).
+ */
+#ifndef USB_DEVICE_VID
+#define USB_DEVICE_VID 0xCAFE
+#endif
+#ifndef USB_DEVICE_PID
+#define USB_DEVICE_PID 0x4021 // CDC + MIDI
+#endif
+
+/**
+ * @brief Longest a stdio write waits for the host to drain the CDC buffer (us).
+ */
+#ifndef USB_STDIO_WRITE_TIMEOUT_US
+#define USB_STDIO_WRITE_TIMEOUT_US 10000
+#endif
+
+/**
+ * @brief Longest thread-context stdio waits for the USB task to release
+ * TinyUSB (us); IRQ handlers never wait.
+ */
+#ifndef USB_STDIO_LOCK_TIMEOUT_US
+#define USB_STDIO_LOCK_TIMEOUT_US 1000000
+#endif
+
+/**
+ * @brief Starts the USB device and installs it as a stdio driver.
+ *
+ * Call right after stdio_init_all().
+ */
+void initUsbDevice(void);
+
+/**
+ * @brief Stops the frame tick, so that it does not wake the core every
+ * millisecond; call just before clocking down.
+ */
+void usbDeviceSleep(void);
+
+/**
+ * @brief Restarts the frame tick stopped by usbDeviceSleep().
+ */
+void usbDeviceWake(void);
+
+#endif // USB_DEVICE_H
@@ -0,0 +1,108 @@
+/**
+ * @file usb_midi.c
+ * @brief USB-MIDI note output and input over the composite device.
+ */
+#include "usb_midi.h"
+#include "tusb.h"
+#include "event_queue.h"
+
+#define USB_MIDI_CABLE 0
+#define USB_MIDI_NOTE_OFF 0x80
+#define USB_MIDI_NOTE_ON 0x90
+
+// Events per bulk packet: 64 bytes of 4-byte USB-MIDI event packets.
+#define USB_MIDI_BATCH_EVENTS (CFG_TUD_MIDI_TX_BUFSIZE / 4)
+
+static EventQueue usb_midi_out;
+static UsbMidiNoteFn usb_midi_on_note = NULL;
+static UsbMidiActivityFn usb_midi_on_activity = NULL;
+static volatile uint32_t usb_midi_write_drops = 0;
+
+void initUsbMidi(UsbMidiNoteFn on_note, UsbMidiActivityFn on_activity)
+{
+  eventQueueInit(&usb_midi_out);
+  usb_midi_on_note = on_note;
+  usb_midi_on_activity = on_activity;
+}
+
+void usbMidiNoteOn(uint8_t note, uint8_t velocity)
+{
+  NoteEvent event = {.type = NOTE_EVENT_ON, .note = note, .velocity = velocity};
+  eventQueuePush(&usb_midi_out, &event);
+}
+
+void usbMidiNoteOff(uint8_t note)
+{
+  NoteEvent event = {.type = NOTE_EVENT_OFF, .note = note};
+  eventQueuePush(&usb_midi_out, &event);
+}
+
+uint32_t usbMidiDroppedEvents(void)
+{
+  return eventQueueOverflows(&usb_midi_out) + usb_midi_write_drops;
+}
+
+/**
+ * @brief Writes the queued notes as one stream write, so one bulk transfer.
+ */
+static void usbMidiSend(void)
+{
+  bool mounted = tud_midi_mounted();
+  uint8_t batch[USB_MIDI_BATCH_EVENTS * 3];
+  uint32_t length = 0;
+  NoteEvent event;
+
+  while (length < sizeof(batch) && eventQueuePop(&usb_midi_out, &event))
+  {
+    if (event.type == NOTE_EVENT_ON)
+    {
+      batch[length++] = USB_MIDI_NOTE_ON | USB_MIDI_CHANNEL;
+      batch[length++] = event.note & 0x7F;
+      batch[length++] = event.velocity & 0x7F;
+    }
+    else
+    {
+      batch[length++] = USB_MIDI_NOTE_OFF | USB_MIDI_CHANNEL;
+      batch[length++] = event.note & 0x7F;
+      batch[length++] = 0;
+    }
+  }
+
+  // Without a host the notes are just discarded, so later ones aren't stale.
+  if (mounted && length > 0)
+  {
+    // A full TX FIFO takes only part of the batch: every message not written
+    // completely is lost.
+    uint32_t written = tud_midi_stream_write(USB_MIDI_CABLE, batch, length);
+    if (written < length)
+      usb_midi_write_drops += (length - written + 2) / 3;
+  }
+}
+
+/**
+ * @brief Dispatches the note messages received since the last frame.
+ */
+static void usbMidiReceive(void)
+{
+  uint8_t packet[4];
+  if (usb_midi_on_activity && tud_midi_available())
+    usb_midi_on_activity();
+  while (tud_midi_packet_read(packet))
+  {
+    // packet[0] is cable and code index; [1..3] the MIDI message.
+    uint8_t status = packet[1] & 0xF0;
+    if (usb_midi_on_note == NULL)
+      continue;
+    if (status == USB_MIDI_NOTE_ON)
+      usb_midi_on_note(packet[2] & 0x7F, packet[3] & 0x7F);
+    else if (status == USB_MIDI_NOTE_OFF)
+      usb_midi_on_note(packet[2] & 0x7F, 0);
+  }
+}
+
+void usbMidiTask(void)
+{
+  usbMidiSend();
+  if (tud_midi_mounted())
+    usbMidiReceive();
+}
@@ -0,0 +1,68 @@
+/**
+ * @file usb_midi.h
+ * @brief USB-MIDI note output and input over the composite device.
+ *
+ * Note calls from the scanner only queue the event (the SPSC queue of
+ * event_queue.h); the USB task drains the queue once per frame and writes
+ * everything pending as one bulk transfer, so a chord leaves in the same
+ * 1 ms frame. Incoming note messages (any channel) are handed to a callback
+ * from the USB task IRQ.
+ */
+#ifndef USB_MIDI_H
+#define USB_MIDI_H
+
+#include <stdint.h>
+
+/**
+ * @brief MIDI channel (0-15) of the notes sent.
+ */
+#ifndef USB_MIDI_CHANNEL
+#define USB_MIDI_CHANNEL 0
+#endif
+
+/**
+ * @brief Receives an incoming note (USB task IRQ context).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ */
+typedef void (*UsbMidiNoteFn)(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Called once per USB frame in which any MIDI packet arrived (USB task
+ * IRQ context), before its notes are dispatched.
+ */
+typedef void (*UsbMidiActivityFn)(void);
+
+/**
+ * @brief Sets up the output queue and the incoming note callbacks.
+ * @param on_note Callback for received notes (may be NULL)
+ * @param on_activity Callback for received packets of any kind (may be NULL)
+ */
+void initUsbMidi(UsbMidiNoteFn on_note, UsbMidiActivityFn on_activity);
+
+/**
+ * @brief Queues a note on for the next USB frame (thread context, core 0).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity 1..127
+ */
+void usbMidiNoteOn(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Queues a note off for the next USB frame (thread context, core 0).
+ * @param note MIDI note number
+ */
+void usbMidiNoteOff(uint8_t note);
+
+/**
+ * @brief Notes dropped because the host fell behind: the output queue was
+ * full, or the TX FIFO took only part of a batch.
+ */
+uint32_t usbMidiDroppedEvents(void);
+
+/**
+ * @brief Sends the queued notes and dispatches received ones; called by the
+ * USB task with TinyUSB locked.
+ */
+void usbMidiTask(void);
+
+#endif // USB_MIDI_H
@@ -0,0 +1,75 @@
+/**
+ * @file wavetable.h
+ * @brief Single-cycle wavetables read by a 32-bit phase accumulator.
+ *
+ * Tables hold one period of WAVETABLE_SIZE signed 16-bit samples, a power of
+ * two, so the top WAVETABLE_BITS of the phase are the index and wrapping is a
+ * mask. The next 15 phase bits linearly interpolate between neighbours. Each
+ * table ends with a copy of its first sample, so code that reads an entry and
+ * the one after it from a pointer (the interpolator path in synth.c) needs no
+ * wrap.
+ *
+ * Tables are const and read from flash through the XIP cache by default;
+ * with WAVETABLE_IN_SRAM they are copied to SRAM at boot so oscillators never
+ * stall on a cache miss.
+ */
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <stdint.h>
+
+#ifndef WAVETABLE_BITS
+#define WAVETABLE_BITS 8
+#endif
+
+#define WAVETABLE_SIZE (1u << WAVETABLE_BITS)
+#define WAVETABLE_MASK (WAVETABLE_SIZE - 1)
+#define WAVETABLE_LENGTH (WAVETABLE_SIZE + 1) //!< Entries stored, with the guard
+
+/**
+ * @brief 1 to interpolate between table entries, 0 for nearest sample.
+ */
+#ifndef WAVETABLE_INTERPOLATE
+#define WAVETABLE_INTERPOLATE 1
+#endif
+
+/**
+ * @brief 1 to keep the tables in SRAM instead of flash.
+ */
+#ifndef WAVETABLE_IN_SRAM
+#define WAVETABLE_IN_SRAM 0
+#endif
+
+#if WAVETABLE_IN_SRAM
+#include "pico.h"
+#define WAVETABLE_STORAGE __not_in_flash("wavetable")
+#else
+#define WAVETABLE_STORAGE
+#endif
+
+extern const int16_t wavetable_sine[WAVETABLE_LENGTH];
+extern const int16_t wavetable_triangle[WAVETABLE_LENGTH];
+extern const int16_t wavetable_saw[WAVETABLE_LENGTH];
+extern const int16_t wavetable_piano[WAVETABLE_LENGTH];
+
+/**
+ * @brief Reads a table at a phase.
+ * @param table One-period table of WAVETABLE_SIZE samples
+ * @param phase Phase, one period per 2^32
+ * @return Sample at that phase
+ */
+static inline int32_t wavetableSample(const int16_t *table, uint32_t phase)
+{
+  uint32_t index = phase >> (32 - WAVETABLE_BITS);
+#if WAVETABLE_INTERPOLATE
+  int32_t a = table[index];
+  int32_t b = table[(index + 1) & WAVETABLE_MASK];
+  // 15-bit fraction keeps (b - a) * frac within int32
+  int32_t frac = (int32_t)((phase >> (17 - WAVETABLE_BITS)) & 0x7FFF);
+  return a + (((b - a) * frac) >> 15);
+#else
+  return table[index];
+#endif
+}
+
+#endif // WAVETABLE_H
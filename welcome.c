@@ -0,0 +1,63 @@
+/**
+ * @file welcome.c
+ * @brief Start-up jingle played in the background on the tick scheduler.
+ */
+#include "welcome.h"
+#include "scheduler.h"
+
+// A rising C major arpeggio.
+static const uint8_t welcome_notes[] = {72, 76, 79, 84};
+#define WELCOME_NOTE_COUNT (sizeof(welcome_notes) / sizeof(welcome_notes[0]))
+
+static WelcomeNoteFn welcome_play;
+static volatile SchedulerId welcome_event = 0;
+static uint32_t welcome_index = 0; //!< Next note to start
+static uint8_t welcome_note = 0;   //!< Note sounding, 0 if none
+
+/**
+ * @brief Scheduler callback: starts the next note, or ends the one sounding.
+ */
+static uint32_t welcomeNoteCallback(void *user_data)
+{
+  (void)user_data;
+
+  if (welcome_note)
+  {
+    welcome_play(welcome_note, 0);
+    welcome_note = 0;
+    if (welcome_index >= WELCOME_NOTE_COUNT)
+    {
+      welcome_event = 0;
+      return 0;
+    }
+    return WELCOME_GAP_MS * 1000u;
+  }
+
+  welcome_note = welcome_notes[welcome_index++];
+  welcome_play(welcome_note, WELCOME_VELOCITY);
+  return WELCOME_NOTE_MS * 1000u;
+}
+
+void welcomePlay(WelcomeNoteFn play)
+{
+  welcomeStop();
+  welcome_play = play;
+  welcome_index = 0;
+  welcome_event = schedulerIn(0, welcomeNoteCallback, NULL);
+}
+
+void welcomeStop(void)
+{
+  schedulerCancel(welcome_event);
+  welcome_event = 0;
+  if (welcome_note)
+  {
+    welcome_play(welcome_note, 0);
+    welcome_note = 0;
+  }
+}
+
+bool welcomePlaying(void)
+{
+  return welcome_event > 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file welcome.h
+ * @brief Start-up jingle played in the background on the tick scheduler.
+ *
+ * Unlike playWelcomeTones(), which sleeps through every note before the
+ * first keypad scan, welcomePlay() only schedules the first note. Each note
+ * starts and ends in a scheduler event, so the keyboard plays from the start
+ * while the jingle is still sounding, on whatever output the notes go to.
+ */
+#ifndef WELCOME_H
+#define WELCOME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief How long each jingle note sounds, and the silence after it (ms).
+ */
+#ifndef WELCOME_NOTE_MS
+#define WELCOME_NOTE_MS 90
+#endif
+#ifndef WELCOME_GAP_MS
+#define WELCOME_GAP_MS 20
+#endif
+
+/**
+ * @brief Velocity of the jingle notes.
+ */
+#ifndef WELCOME_VELOCITY
+#define WELCOME_VELOCITY 96
+#endif
+
+/**
+ * @brief Plays a jingle note (scheduler IRQ context).
+ * @param note MIDI note number
+ * @param velocity MIDI velocity, 0 for note off
+ */
+typedef void (*WelcomeNoteFn)(uint8_t note, uint8_t velocity);
+
+/**
+ * @brief Starts the jingle and returns immediately.
+ * @param play Callback for the jingle notes
+ */
+void welcomePlay(WelcomeNoteFn play);
+
+/**
+ * @brief Cuts the jingle short, ending the note sounding.
+ */
+void welcomeStop(void);
+
+/**
+ * @brief Checks whether the jingle is still playing.
+ */
+bool welcomePlaying(void);
+
+#endif // WELCOME_H